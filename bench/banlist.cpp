@@ -0,0 +1,103 @@
+/**
+ * @file banlist.cpp
+ * @brief Measures Banlist load time, lookup throughput and ban latency
+ *
+ * Usage: bench_banlist [entries] [reader threads]
+ * (defaults: 1000000 entries, 4 readers)
+ */
+
+#include "Server/Banlist.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string name(size_t i) {
+    return "user" + std::to_string(i);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t readers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+    std::string directory = "/tmp/banlist_bench_" + std::to_string(getpid());
+    std::filesystem::create_directories(directory);
+    std::string path = directory + "/banlist";
+
+    {
+        std::ofstream snapshot(path);
+        for (size_t i = 0; i < entries; ++i) {
+            snapshot << name(i) << "\n";
+        }
+    }
+
+    Banlist banlist(path);
+    auto start = Clock::now();
+    banlist.load();
+    std::cout << "Load:        " << banlist.size() << " entries in " << elapsedMs(start) << " ms\n";
+
+    // Single-threaded lookups, half hits and half misses
+    const size_t lookups = 2000000;
+    size_t hits = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        hits += banlist.contains(name(i % (2 * entries))) ? 1 : 0;
+    }
+    double ms = elapsedMs(start);
+    std::cout << "Lookup:      " << lookups << " in " << ms << " ms (" << ms * 1e6 / lookups
+              << " ns/op incl. key build, " << hits << " hits)\n";
+
+    // Concurrent lookups while an admin keeps banning and unbanning
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> concurrentLookups{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            uint64_t local = 0;
+            for (size_t i = t; !stop.load(std::memory_order_relaxed); i += readers) {
+                (void)banlist.contains(name(i % (2 * entries)));
+                local++;
+            }
+            concurrentLookups += local;
+        });
+    }
+
+    const size_t changes = 2000;
+    start = Clock::now();
+    for (size_t i = 0; i < changes; ++i) {
+        std::string user = "admin_ban_" + std::to_string(i % 100);
+        if (!banlist.add(user)) {
+            banlist.remove(user);
+        }
+    }
+    double banMs = elapsedMs(start);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "Ban/unban:   " << changes << " changes in " << banMs << " ms (" << banMs * 1000 / changes
+              << " us/op, compactions included) with " << readers << " readers doing "
+              << static_cast<uint64_t>(concurrentLookups / (banMs / 1000.0)) << " lookups/s\n";
+
+    start = Clock::now();
+    banlist.compact();
+    std::cout << "Compaction:  " << elapsedMs(start) << " ms (the cost of every ban with a full rewrite)\n";
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file flat_hash_map.cpp
+ * @brief Compares Utils::FlatHashMap with std::unordered_map: lookups and memory
+ *
+ * Usage: bench_flat_hash_map [lookups per measure]
+ * (default: 2000000). Keys are short usernames ("user123", kept inline by
+ * both containers' strings), as in the registry, banlist and command tables.
+ * Memory per entry is the growth of the heap in use (mallinfo2) while the
+ * table is filled: nodes and buckets for std::unordered_map, slot arrays for
+ * FlatHashMap, allocator overhead included.
+ */
+
+#include "Utils/FlatHashMap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <malloc.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Heap bytes in use, including the allocator's per-block overhead and mmap'd blocks
+size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+using StdMap = std::unordered_map<std::string, int>;
+using FlatMap = Utils::FlatHashMap<std::string, int>;
+
+std::string name(size_t i) {
+    return "user" + std::to_string(i);
+}
+
+// Average nanoseconds per lookup over the probe keys, cycled
+template<typename Map>
+double measureLookups(const Map& map, const std::vector<std::string>& probes, size_t lookups, size_t& found) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        auto it = map.find(probes[i % probes.size()]);
+        found += it != map.end() ? static_cast<size_t>(it->second) & 1 : 0;
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(lookups);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t lookups = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::mt19937_64 random(42);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "entries  | hit ns std / flat | miss ns std / flat | bytes/entry std / flat\n";
+
+    for (size_t entries : {size_t{16}, size_t{1000}, size_t{100000}, size_t{1000000}}) {
+        size_t before = heapInUse();
+        StdMap stdMap;
+        for (size_t i = 0; i < entries; ++i) {
+            stdMap.emplace(name(i), static_cast<int>(i));
+        }
+        double stdBytes = static_cast<double>(heapInUse() - before) / static_cast<double>(entries);
+
+        before = heapInUse();
+        FlatMap flatMap;
+        for (size_t i = 0; i < entries; ++i) {
+            flatMap.emplace(name(i), static_cast<int>(i));
+        }
+        double flatBytes = static_cast<double>(heapInUse() - before) / static_cast<double>(entries);
+
+        // Random order so large tables are not walked in insertion order
+        std::vector<std::string> hits;
+        std::vector<std::string> misses;
+        size_t probes = std::min<size_t>(entries, 100000);
+        for (size_t i = 0; i < probes; ++i) {
+            hits.push_back(name(random() % entries));
+            misses.push_back("nobody" + std::to_string(random() % entries));
+        }
+
+        size_t found = 0;
+        double stdHit = measureLookups(stdMap, hits, lookups, found);
+        double flatHit = measureLookups(flatMap, hits, lookups, found);
+        double stdMiss = measureLookups(stdMap, misses, lookups, found);
+        double flatMiss = measureLookups(flatMap, misses, lookups, found);
+
+        std::cout << std::setw(8) << entries << " | " << std::setw(6) << stdHit << " / " << std::setw(5) << flatHit
+                  << " | " << std::setw(7) << stdMiss << " / " << std::setw(5) << flatMiss
+                  << " | " << std::setw(9) << stdBytes << " / " << std::setw(5) << flatBytes
+                  << (found == 0 ? " (nothing found)" : "") << "\n";
+    }
+    return 0;
+}
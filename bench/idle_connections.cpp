@@ -0,0 +1,204 @@
+/**
+ * @file idle_connections.cpp
+ * @brief Measures memory per idle authenticated connection and heartbeat CPU in event loop mode
+ *
+ * Usage: bench_idle_connections [connections] [heartbeat window (s)]
+ * (defaults: 100000 connections, 15 s). Runs a real server in event loop mode
+ * (bench_idle_connections_coro, from make coro: one coroutine per connection)
+ * on an ephemeral port in a temporary directory; a forked child opens the
+ * connections over loopback (spread over 127.0.0.x to stay within the
+ * ephemeral port range), sends CONNECT on each and then stays silent. The
+ * connection count is capped by RLIMIT_NOFILE.
+ *
+ * Reported: resident bytes per connection (growth of the server's RSS; the
+ * kernel's socket buffers are not part of it) and the server CPU time spent
+ * while every client is idle, which with HEARTBEAT_INTERVAL_S at its minimum
+ * (5 s) is the heartbeat's PING rounds; the CPU time of an idle server over
+ * the same window is subtracted.
+ */
+
+#include "Server/Server.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int HEARTBEAT_INTERVAL_S = 5;
+constexpr size_t CONNECTIONS_PER_ADDRESS = 25000;  // Below the default ephemeral port range
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0;
+    size_t resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+double cpuSeconds() {
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+size_t threadCount() {
+    size_t count = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator("/proc/self/task")) {
+        ++count;
+    }
+    return count;
+}
+
+// Raises the descriptor limit as far as allowed; returns the usable count
+size_t raiseFileLimit(size_t wanted) {
+    rlimit limit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, wanted);
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+void sendFrame(int fd, const std::string& text) {
+    uint32_t length = htonl(static_cast<uint32_t>(text.size()));
+    std::string frame(reinterpret_cast<const char*>(&length), sizeof(length));
+    frame += text;
+    (void)::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+// Child process: opens the connections, reports how many, then idles
+[[noreturn]] void runClients(int port, size_t connections, int reportFd) {
+    size_t opened = 0;
+    for (; opened < connections; ++opened) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(0x7F000001u + static_cast<uint32_t>(opened / CONNECTIONS_PER_ADDRESS));
+
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "Client " << opened << ": " << std::strerror(errno) << "\n";
+            break;
+        }
+        sendFrame(fd, "CONNECT;idle" + std::to_string(opened) + "\n");
+    }
+    (void)::write(reportFd, &opened, sizeof(opened));
+    while (true) {
+        ::pause();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t connections = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    int windowS = argc > 2 ? std::atoi(argv[2]) : 15;
+
+    size_t limit = raiseFileLimit(connections + 256);
+    if (limit < connections + 256) {
+        connections = limit > 256 ? limit - 256 : 0;
+        std::cout << "RLIMIT_NOFILE allows " << limit << " descriptors: measuring " << connections << " connections\n";
+    }
+
+    // The child is forked before the server starts any thread
+    int portPipe[2];
+    int reportPipe[2];
+    if (::pipe(portPipe) < 0 || ::pipe(reportPipe) < 0) {
+        std::cerr << "pipe failed\n";
+        return 1;
+    }
+    pid_t child = ::fork();
+    if (child == 0) {
+        int port = 0;
+        if (::read(portPipe[0], &port, sizeof(port)) != sizeof(port)) {
+            ::_exit(1);
+        }
+        runClients(port, connections, reportPipe[1]);
+    }
+
+    std::string directory = "/tmp/idle_bench_" + std::to_string(getpid());
+    std::filesystem::create_directories(directory);
+    std::filesystem::current_path(directory);
+
+    RuntimeConfig::getInstance().set("HEARTBEAT_INTERVAL_S", std::to_string(HEARTBEAT_INTERVAL_S));
+    RuntimeConfig::getInstance().set("HEARTBEAT_TIMEOUT_S", "3600");
+
+    Server server;
+#ifndef ENABLE_COROUTINES
+    server.setEventLoop(true);
+#endif
+    if (server.start(0, 4096) != 0) {
+        std::cerr << "Cannot start the server\n";
+        ::kill(child, SIGKILL);
+        return 1;
+    }
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    ::getsockname(server.getConfig().socket, reinterpret_cast<sockaddr*>(&bound), &length);
+    int port = ntohs(bound.sin_port);
+
+    // Idle server: startup settled, baseline CPU of the background threads
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    size_t rssBefore = residentBytes();
+    double cpuStart = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::seconds(windowS));
+    double baselineCpu = cpuSeconds() - cpuStart;
+
+    auto start = Clock::now();
+    (void)::write(portPipe[1], &port, sizeof(port));
+    size_t opened = 0;
+    if (::read(reportPipe[0], &opened, sizeof(opened)) != sizeof(opened)) {
+        std::cerr << "Client process failed\n";
+        return 1;
+    }
+    while (static_cast<size_t>(server.getClientCount()) < opened &&
+           Clock::now() - start < std::chrono::seconds(120)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    double connectS = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t registered = static_cast<size_t>(server.getClientCount());
+    if (registered == 0) {
+        std::cerr << "No client registered\n";
+        ::kill(child, SIGKILL);
+        return 1;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    size_t rssAfter = residentBytes();
+
+    // Every client is silent: each timer fires once per interval and PINGs
+    cpuStart = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::seconds(windowS));
+    double heartbeatCpu = std::max(0.0, cpuSeconds() - cpuStart - baselineCpu);
+    double rounds = static_cast<double>(windowS) / HEARTBEAT_INTERVAL_S;
+
+    std::cout << registered << " idle connections (" << opened << " opened) in " << connectS << " s, "
+              << threadCount() << " server threads\n"
+              << "  resident: " << (rssAfter - rssBefore) / registered << " bytes/connection ("
+              << (rssAfter - rssBefore) / (1024 * 1024) << " MiB total)\n"
+              << "  heartbeat (interval " << HEARTBEAT_INTERVAL_S << " s, " << windowS << " s window): "
+              << heartbeatCpu * 1000.0 / rounds << " ms CPU per round, "
+              << heartbeatCpu * 1e6 / rounds / static_cast<double>(registered) << " us per connection per round"
+              << " (idle server baseline " << baselineCpu * 1000.0 << " ms subtracted)\n";
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    std::filesystem::current_path("/");
+    std::filesystem::remove_all(directory);
+    std::exit(0);  // Server threads are detached; stop() would exit too
+}
@@ -0,0 +1,144 @@
+/**
+ * @file logger.cpp
+ * @brief Compares the cost of a LOG_DEBUGF call in synchronous and async logging,
+ * to the text log file and to the binary log
+ *
+ * Usage: bench_logger [records per thread] [threads]
+ * (defaults: 200000 records, 4 threads). Each thread logs records of the
+ * size of a dispatch line to a log file in a temporary directory; at minimum
+ * level DEBUG without -v, they are not mirrored to the console. Reported per call: average, p50, p99
+ * and max time spent in the caller (each call is timed, which adds about
+ * 20 ns), and the total time until every record is in the file: the text
+ * file, then the binary ring file of --binary-log.
+ *
+ * Then the cost of a suppressed DEBUG site (minimum level INFO) written as
+ * before (message built, then dropped inside Logger::log), as LOG_DEBUG and
+ * as LOG_DEBUGF.
+ */
+
+#include "Utils/Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double avgNs;
+    double p50Ns;
+    double p99Ns;
+    double maxNs;
+    double totalMs;
+};
+
+Result run(bool async, size_t records, size_t threads) {
+    Logger& logger = Logger::getInstance();
+    logger.setAsync(async);
+
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::string from = "user" + std::to_string(t);
+            latencies[t].reserve(records);
+            for (size_t i = 0; i < records; ++i) {
+                auto before = Clock::now();
+                LOG_DEBUGF("Message dispatched from {} to somebody, queue depth {}", from, i);
+                latencies[t].push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    logger.setAsync(false);  // Drains what is left
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto& list : latencies) {
+        all.insert(all.end(), list.begin(), list.end());
+    }
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (double value : all) {
+        sum += value;
+    }
+    auto at = [&](double q) { return all[std::min(all.size() - 1, static_cast<size_t>(q * all.size()))]; };
+    return {sum / static_cast<double>(all.size()), at(0.50), at(0.99), all.back(), totalMs};
+}
+
+template<typename Site>
+double nsPerCall(size_t calls, Site site) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < calls; ++i) {
+        site(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(calls);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+    std::string directory = "/tmp/logger_bench_" + std::to_string(getpid());
+    std::filesystem::create_directories(directory);
+    Logger::getInstance().setLogFile(directory + "/bench.log");
+
+    // The console output of the logger goes to /dev/null, results to the real stdout
+    std::cout.flush();
+    int console = ::dup(STDOUT_FILENO);
+    int null = ::open("/dev/null", O_WRONLY);
+    ::dup2(null, STDOUT_FILENO);
+    Logger::getInstance().setMinimumLevel(LogLevel::DEBUG);
+    Result sync = run(false, records, threads);
+    Result async = run(true, records, threads);
+    Logger::getInstance().setBinaryLog(directory + "/bench.binlog");  // For good: last
+    Result binarySync = run(false, records, threads);
+    Result binaryAsync = run(true, records, threads);
+    std::cout.flush();
+    ::dup2(console, STDOUT_FILENO);
+
+    std::cout << records << " records x " << threads << " thread(s), " << std::thread::hardware_concurrency()
+              << " hardware threads\n"
+              << "mode          avg ns    p50 ns    p99 ns    max ns   total ms\n"
+              << std::fixed << std::setprecision(0);
+    for (const auto& [label, result] : {std::pair<const char*, Result>{"sync", sync}, {"async", async},
+                                           {"bin+sync", binarySync}, {"bin+async", binaryAsync}}) {
+        std::cout << std::left << std::setw(10) << label << std::right << std::setw(10) << result.avgNs
+                  << std::setw(10) << result.p50Ns << std::setw(10) << result.p99Ns << std::setw(10) << result.maxNs
+                  << std::setw(11) << result.totalMs << "\n";
+    }
+
+    // Suppressed DEBUG sites
+    Logger::getInstance().setMinimumLevel(LogLevel::INFO);
+    std::string from = "alice";
+    std::string to = "bob";
+    size_t calls = records * 10;
+    double eager = nsPerCall(calls, [&](size_t i) {
+        Logger::getInstance().log(LogLevel::DEBUG, "Message dispatched from " + from + " to " + to + " #" + std::to_string(i));
+    });
+    double checked = nsPerCall(calls, [&](size_t i) {
+        LOG_DEBUG("Message dispatched from " + from + " to " + to + " #" + std::to_string(i));
+    });
+    double lazy = nsPerCall(calls, [&](size_t i) {
+        LOG_DEBUGF("Message dispatched from {} to {} #{}", from, to, i);
+    });
+    std::cout << std::setprecision(2) << "suppressed DEBUG site (" << LOG_COMPILE_LEVEL << " compile floor): built then dropped "
+              << eager << " ns, LOG_DEBUG " << checked << " ns, LOG_DEBUGF " << lazy << " ns\n";
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
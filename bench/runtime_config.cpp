@@ -0,0 +1,102 @@
+/**
+ * @file runtime_config.cpp
+ * @brief Cost of a RuntimeConfig read, as done by isValidUsername on every CONNECT and SEND
+ *
+ * Usage: bench_runtime_config [reads per thread] [threads]
+ * (defaults: 2000000 reads, 4 threads). Compares, in ns per read:
+ *  - the former path, reproduced here: mutex, string-keyed lookup, std::stoi;
+ *  - read(): typed field of the snapshot;
+ * each with 1 thread and with every thread reading at once, then read() again
+ * while a writer publishes a /set every millisecond. Both are compiled here
+ * (-O2); getInt() is left out, being built with the server objects (-O0).
+ */
+
+#include "Utils/FlatHashMap.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The configuration as it was stored before snapshots
+struct StringConfig {
+    std::mutex mutex;
+    Utils::FlatHashMap<std::string, std::string> values;
+
+    int getInt(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = values.find(key);
+        return it == values.end() ? 0 : std::stoi(it->second);
+    }
+};
+
+// Average ns per call over all threads (each thread makes `reads` calls)
+template<typename Read>
+double nsPerRead(size_t reads, size_t threads, Read read) {
+    std::atomic<long long> sink{0};
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            long long sum = 0;
+            for (size_t i = 0; i < reads; ++i) {
+                sum += read();
+            }
+            sink += sum;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / static_cast<double>(reads);  // Wall time per read of one thread
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t reads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+    RuntimeConfig& runtime = RuntimeConfig::getInstance();
+    StringConfig before;
+    for (const auto& [key, value] : runtime.listAll()) {
+        before.values[key] = value;
+    }
+
+    auto former = [&] { return before.getInt("MAX_USERNAME_LENGTH"); };
+    auto typed = [&] { return runtime.read([](const ConfigSnapshot& config) { return config.maxUsernameLength; }); };
+
+    std::cout << reads << " reads per thread, " << std::thread::hardware_concurrency() << " hardware threads\n"
+              << "path                          1 thread   " << threads << " threads (ns per read)\n"
+              << std::fixed << std::setprecision(1);
+    auto row = [&](const char* label, auto read) {
+        std::cout << std::left << std::setw(30) << label << std::right << std::setw(8) << nsPerRead(reads, 1, read)
+                  << std::setw(12) << nsPerRead(reads, threads, read) << "\n";
+    };
+    row("mutex + lookup + stoi (former)", former);
+    row("read()", typed);
+
+    std::atomic<bool> writing{true};
+    size_t sets = 0;
+    std::thread writer([&] {
+        while (writing) {
+            runtime.set("MAX_USERNAME_LENGTH", std::to_string(20 + sets++ % 10));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    double busy = nsPerRead(reads, threads, typed);
+    writing = false;
+    writer.join();
+    std::cout << "read() during " << sets << " /set: " << busy << " ns per read (" << threads << " threads)\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file send_throughput.cpp
+ * @brief Measures SEND throughput and socket lookups as the session count grows
+ *
+ * Usage: bench_send_throughput [messages per round]
+ * (default: 20000). Runs a real server on an ephemeral port in a temporary
+ * directory; idle sessions are registered on unused descriptor numbers. The
+ * SEND handler (parse, sender and recipient lookups, enqueue, OK reply) is
+ * timed on the calling thread: the dispatcher paces deliveries
+ * (DispatcherConfig::delayBetweenMessages), so end-to-end delivery would only
+ * measure that delay.
+ */
+
+#include "Server/Server.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int IDLE_SOCKET_BASE = 200000;  // Far above any real descriptor
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Reads length-prefixed frames and counts them
+void drain(int fd, std::atomic<uint64_t>& frames) {
+    std::vector<char> buffer(64 * 1024);
+    size_t pending = 0;
+    while (true) {
+        ssize_t received = ::recv(fd, buffer.data() + pending, buffer.size() - pending, 0);
+        if (received <= 0) {
+            return;
+        }
+        pending += static_cast<size_t>(received);
+
+        size_t offset = 0;
+        while (pending - offset >= 4) {
+            uint32_t length = (static_cast<uint8_t>(buffer[offset]) << 24) | (static_cast<uint8_t>(buffer[offset + 1]) << 16) |
+                              (static_cast<uint8_t>(buffer[offset + 2]) << 8) | static_cast<uint8_t>(buffer[offset + 3]);
+            if (pending - offset < 4 + length) {
+                break;
+            }
+            offset += 4 + length;
+            frames.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::copy(buffer.begin() + static_cast<long>(offset), buffer.begin() + static_cast<long>(pending), buffer.begin());
+        pending -= offset;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    std::string directory = "/tmp/send_bench_" + std::to_string(getpid());
+    std::filesystem::create_directories(directory);
+    std::filesystem::current_path(directory);
+
+    // Measure the registry, not the history disk writes; room for every round in the queue
+    RuntimeConfig::getInstance().set("HISTORY_ENABLED", "false");
+    RuntimeConfig::getInstance().set("MAX_QUEUE_SIZE", "100000");
+
+    Server server;
+    if (server.start(0, 0) != 0) {
+        std::cerr << "Cannot start the server\n";
+        return 1;
+    }
+
+    int senderPair[2];
+    int recipientPair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, senderPair) < 0 ||
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, recipientPair) < 0) {
+        std::cerr << "socketpair failed\n";
+        return 1;
+    }
+    server.registerClient("sender", senderPair[0]);
+    server.registerClient("recipient", recipientPair[0]);
+
+    std::atomic<uint64_t> replies{0};
+    std::atomic<uint64_t> delivered{0};
+    std::thread(drain, senderPair[1], std::ref(replies)).detach();
+    std::thread(drain, recipientPair[1], std::ref(delivered)).detach();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Let the startup settle
+
+    const std::vector<std::string> args = {"recipient", "bench subject", "payload"};
+    size_t registered = 2;
+
+    for (size_t sessions : {size_t{10}, size_t{1000}, size_t{100000}}) {
+        for (; registered < sessions; ++registered) {
+            server.registerClient("idle" + std::to_string(registered), IDLE_SOCKET_BASE + static_cast<int>(registered));
+        }
+
+        // Lookup used by every SEND, PONG and disconnect
+        const size_t lookups = 1000000;
+        auto start = Clock::now();
+        size_t found = 0;
+        for (size_t i = 0; i < lookups; ++i) {
+            found += server.getSessionBySocket(IDLE_SOCKET_BASE + static_cast<int>(2 + i % (sessions - 2))) ? 1 : 0;
+        }
+        double lookupNs = elapsedMs(start) * 1e6 / lookups;
+
+        start = Clock::now();
+        for (size_t i = 0; i < messages; ++i) {
+            server.executeCommand("SEND", args, senderPair[0]);
+        }
+        double sendMs = elapsedMs(start);
+
+        std::cout << sessions << " sessions: " << static_cast<uint64_t>(messages / (sendMs / 1000.0))
+                  << " SEND/s, getSessionBySocket " << lookupNs << " ns ("
+                  << found << "/" << lookups << " found)\n";
+    }
+
+    std::filesystem::current_path("/");
+    std::filesystem::remove_all(directory);
+    std::exit(0);  // Server threads are detached; stop() would exit too
+}
@@ -0,0 +1,184 @@
+/**
+ * @file task.cpp
+ * @brief Compares Utils::Task and std::function as thread pool task wrappers
+ *
+ * Usage: bench_task [tasks per run]
+ * (default: 1000000). For lambdas capturing 8 to 64 bytes, reports the time
+ * and heap allocations per task of:
+ *  - queue: wrap, push to a std::queue, pop and run on one thread (the
+ *    ThreadPool queue path without the locking);
+ *  - pool: ThreadPool with one worker, enqueue() and run, the std::function
+ *    row wrapping the lambda in a std::function first as before.
+ * Fractions of an allocation are the std::queue growing. Then a unique_ptr
+ * capture (which std::function rejects) and the future-returning enqueue()
+ * round trip.
+ */
+
+#include "Utils/Task.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <queue>
+#include <thread>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+// Counts every heap allocation of the process
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<size_t> completed{0};
+uint64_t sink = 0;
+
+template<size_t Bytes>
+struct Capture {
+    uint64_t words[Bytes / sizeof(uint64_t)];
+};
+
+template<size_t Bytes>
+auto makeLambda(size_t i) {
+    Capture<Bytes> capture{};
+    capture.words[0] = i;
+    return [capture] {
+        sink += capture.words[0];
+        completed.fetch_add(1, std::memory_order_relaxed);
+    };
+}
+
+struct Result {
+    double nsPerTask;
+    double allocationsPerTask;
+};
+
+template<typename Run>
+Result measure(size_t tasks, Run run) {
+    completed = 0;
+    uint64_t allocationsBefore = allocations.load();
+    auto start = Clock::now();
+    run();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return {ns / static_cast<double>(tasks),
+            static_cast<double>(allocations.load() - allocationsBefore) / static_cast<double>(tasks)};
+}
+
+template<typename Wrapper, size_t Bytes>
+Result queuePath(size_t tasks) {
+    std::queue<Wrapper> queue;
+    return measure(tasks, [&] {
+        for (size_t i = 0; i < tasks; ++i) {
+            queue.push(Wrapper(makeLambda<Bytes>(i)));
+            Wrapper task = std::move(queue.front());
+            queue.pop();
+            task();
+        }
+    });
+}
+
+void waitFor(size_t tasks) {
+    while (completed.load(std::memory_order_relaxed) < tasks) {
+        std::this_thread::yield();
+    }
+}
+
+template<bool WrapInFunction, size_t Bytes>
+Result poolPath(size_t tasks) {
+    ThreadPool pool(1);
+    return measure(tasks, [&] {
+        for (size_t i = 0; i < tasks; ++i) {
+            if constexpr (WrapInFunction) {
+                pool.enqueue(std::function<void()>(makeLambda<Bytes>(i)));
+            } else {
+                pool.enqueue(makeLambda<Bytes>(i));
+            }
+        }
+        waitFor(tasks);
+    });
+}
+
+void print(const char* label, const Result& function, const Result& task) {
+    std::cout << "  " << std::left << std::setw(24) << label << std::right << std::fixed
+              << std::setprecision(1) << std::setw(9) << function.nsPerTask << " ns " << std::setprecision(2)
+              << std::setw(5) << function.allocationsPerTask << " alloc" << std::setprecision(1) << std::setw(11)
+              << task.nsPerTask << " ns " << std::setprecision(2) << std::setw(5) << task.allocationsPerTask
+              << " alloc\n";
+}
+
+template<size_t Bytes>
+void compare(size_t tasks) {
+    std::string capture = std::to_string(Bytes) + "-byte capture";
+    print(("queue, " + capture).c_str(), queuePath<std::function<void()>, Bytes>(tasks),
+          queuePath<Utils::Task, Bytes>(tasks));
+    print(("pool, " + capture).c_str(), poolPath<true, Bytes>(tasks), poolPath<false, Bytes>(tasks));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "Per task, " << tasks << " tasks (sizeof std::function " << sizeof(std::function<void()>)
+              << ", sizeof Task " << sizeof(Utils::Task) << ", inline up to " << Utils::Task::INLINE_SIZE
+              << " bytes)\n"
+              << "  " << std::setw(24) << "" << std::setw(22) << "std::function" << std::setw(22) << "Task" << "\n";
+    compare<8>(tasks);
+    compare<16>(tasks);
+    compare<32>(tasks);
+    compare<48>(tasks);
+    compare<64>(tasks);
+
+    // A buffer handed over to the task: std::function would not compile
+    Result moveOnly = measure(tasks, [&] {
+        ThreadPool pool(1);
+        for (size_t i = 0; i < tasks; ++i) {
+            auto buffer = std::make_unique<uint64_t>(i);
+            pool.enqueue([buffer = std::move(buffer)] {
+                sink += *buffer;
+                completed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        waitFor(tasks);
+    });
+    std::cout << "  unique_ptr capture, pool: " << std::setprecision(1) << moveOnly.nsPerTask << " ns, "
+              << std::setprecision(2) << moveOnly.allocationsPerTask << " alloc (the buffer's own included)\n";
+
+    // Future-returning enqueue(): one task in flight at a time
+    size_t roundTrips = tasks / 100;
+    Result future = measure(roundTrips, [&] {
+        ThreadPool pool(1);
+        for (size_t i = 0; i < roundTrips; ++i) {
+            sink += pool.enqueue(std::packaged_task<uint64_t()>([i] { return i; })).get();
+        }
+    });
+    std::cout << "  enqueue(packaged_task).get() round trip: " << std::setprecision(1) << future.nsPerTask
+              << " ns, " << std::setprecision(2) << future.allocationsPerTask << " alloc\n";
+
+    return sink == 42 ? 1 : 0;  // Keeps the work from being optimized out
+}
@@ -0,0 +1,227 @@
+/**
+ * @file thread_placement.cpp
+ * @brief Measures message delivery latency with and without thread pinning
+ *
+ * Usage: bench_thread_placement [messages] [load threads] [affinity spec]
+ * (defaults: 500 messages, no load, "auto"). Each placement runs in its own
+ * forked process: a real server in event loop mode on an ephemeral port, in
+ * a temporary directory, with two clients. The sender sends one SEND at a
+ * time carrying its send time and waits for the receiver to get the MESSAGE;
+ * the load threads (unpinned busy loops) compete for the CPUs meanwhile.
+ *
+ * The latency includes the dispatcher's pacing between messages
+ * (DispatcherConfig::delayBetweenMessages), which pinning cannot change: the
+ * spread above it (p99 - p50, max) is what placement affects.
+ */
+
+#include "Server/Server.hpp"
+#include "Utils/ThreadPlacement.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Percentiles {
+    double p50;
+    double p99;
+    double p999;
+    double max;
+    size_t count;
+};
+
+std::atomic<bool> loadRunning{true};
+std::atomic<size_t> delivered{0};
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void sendFrame(int fd, const std::string& text) {
+    uint32_t length = htonl(static_cast<uint32_t>(text.size()));
+    std::string frame(reinterpret_cast<const char*>(&length), sizeof(length));
+    frame += text;
+    (void)::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+// Returns the next frame, empty once the connection is closed
+std::string readFrame(int fd) {
+    uint32_t length = 0;
+    if (::recv(fd, &length, sizeof(length), MSG_WAITALL) != sizeof(length)) {
+        return "";
+    }
+    std::string frame(ntohl(length), '\0');
+    if (::recv(fd, frame.data(), frame.size(), MSG_WAITALL) != static_cast<ssize_t>(frame.size())) {
+        return "";
+    }
+    return frame;
+}
+
+int connectClient(int port, const std::string& name) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        return -1;
+    }
+    sendFrame(fd, "CONNECT;" + name + "\n");
+    return readFrame(fd).rfind("OK", 0) == 0 ? fd : -1;
+}
+
+// Child process: one server with the given placement, results written to resultFd
+[[noreturn]] void runPlacement(const std::string& spec, size_t messages, size_t loadThreads, int resultFd) {
+    std::string directory = "/tmp/placement_bench_" + std::to_string(getpid());
+    std::filesystem::create_directories(directory);
+    std::filesystem::current_path(directory);
+
+    Utils::ThreadPlacement placement;
+    std::string error;
+    if (!spec.empty() && !placement.parse(spec, error)) {
+        std::cerr << "Invalid affinity " << spec << ": " << error << "\n";
+        ::_exit(1);
+    }
+
+    Server server;
+    server.setEventLoop(true);
+    server.setPlacement(placement);
+    if (server.start(0, 64) != 0) {
+        std::cerr << "Cannot start the server\n";
+        ::_exit(1);
+    }
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    ::getsockname(server.getConfig().socket, reinterpret_cast<sockaddr*>(&bound), &length);
+    int port = ntohs(bound.sin_port);
+
+    std::vector<std::thread> load;
+    for (size_t i = 0; i < loadThreads; ++i) {
+        load.emplace_back([] {
+            volatile uint64_t spin = 0;
+            while (loadRunning.load(std::memory_order_relaxed)) {
+                spin = spin + 1;
+            }
+        });
+    }
+
+    int sender = connectClient(port, "sender");
+    int receiver = connectClient(port, "receiver");
+    if (sender < 0 || receiver < 0) {
+        std::cerr << "Cannot connect the clients\n";
+        ::_exit(1);
+    }
+
+    // OK replies to the sender are not needed
+    std::thread([sender] {
+        while (!readFrame(sender).empty()) {
+        }
+    }).detach();
+
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(messages);
+    std::thread reader([&] {
+        while (latenciesUs.size() < messages) {
+            std::string frame = readFrame(receiver);
+            if (frame.empty()) {
+                return;
+            }
+            if (frame.rfind("MESSAGE;", 0) != 0) {
+                continue;
+            }
+            // MESSAGE;from;subject;body;timestamp
+            size_t body = frame.find(';', frame.find(';', std::strlen("MESSAGE;")) + 1) + 1;
+            int64_t sentNs = std::strtoll(frame.c_str() + body, nullptr, 10);
+            latenciesUs.push_back(static_cast<double>(nowNs() - sentNs) / 1000.0);
+            delivered.store(latenciesUs.size(), std::memory_order_release);
+        }
+    });
+
+    for (size_t i = 0; i < messages; ++i) {
+        sendFrame(sender, "SEND;receiver;latency;" + std::to_string(nowNs()) + "\n");
+        auto deadline = Clock::now() + std::chrono::seconds(5);
+        while (delivered.load(std::memory_order_acquire) <= i && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        if (delivered.load(std::memory_order_acquire) <= i) {
+            break;  // Lost message: report what was measured
+        }
+    }
+    ::shutdown(receiver, SHUT_RDWR);
+    reader.join();
+    loadRunning = false;
+    for (auto& thread : load) {
+        thread.join();
+    }
+
+    Percentiles result{};
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    result.count = latenciesUs.size();
+    if (!latenciesUs.empty()) {
+        auto at = [&](double q) { return latenciesUs[std::min(latenciesUs.size() - 1, static_cast<size_t>(q * latenciesUs.size()))]; };
+        result.p50 = at(0.50);
+        result.p99 = at(0.99);
+        result.p999 = at(0.999);
+        result.max = latenciesUs.back();
+    }
+    (void)::write(resultFd, &result, sizeof(result));
+
+    std::filesystem::current_path("/");
+    std::filesystem::remove_all(directory);
+    std::exit(0);  // Server threads are detached
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+    size_t loadThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    std::string pinned = argc > 3 ? argv[3] : "auto";
+
+    std::cout << "Delivery latency (us), " << messages << " messages, " << loadThreads << " load thread(s), "
+              << std::thread::hardware_concurrency() << " hardware threads\n"
+              << "placement         count       p50       p99     p99.9       max\n"
+              << std::fixed << std::setprecision(0);
+
+    for (const std::string& spec : {std::string(), pinned}) {
+        int pipeFds[2];
+        if (::pipe(pipeFds) < 0) {
+            return 1;
+        }
+        std::cout.flush();  // The child would print what is still buffered again
+        pid_t child = ::fork();
+        if (child == 0) {
+            runPlacement(spec, messages, loadThreads, pipeFds[1]);
+        }
+        ::close(pipeFds[1]);
+        Percentiles result{};
+        bool ok = ::read(pipeFds[0], &result, sizeof(result)) == sizeof(result);
+        ::close(pipeFds[0]);
+        ::waitpid(child, nullptr, 0);
+        if (!ok) {
+            std::cerr << "Run failed for placement '" << spec << "'\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(16) << (spec.empty() ? "none" : spec) << std::right
+                  << std::setw(7) << result.count << std::setw(10) << result.p50 << std::setw(10) << result.p99
+                  << std::setw(10) << result.p999 << std::setw(10) << result.max << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Compares ThreadPool and WorkStealingPool task throughput at 1 to 64 threads
+ *
+ * Usage: bench_thread_pool [tasks per run]
+ * (default: 200000). Two workloads, each task doing a few hundred
+ * nanoseconds of arithmetic:
+ *  - injected: every task is enqueued by the main thread (like the event
+ *    loop handing readable sockets to the pool);
+ *  - spawned: 1/64 of the tasks are enqueued by the main thread and each
+ *    enqueues 63 follow-up tasks from its worker (like a frame handler
+ *    fanning work out).
+ */
+
+#include "Utils/ThreadPool.hpp"
+#include "Utils/WorkStealingPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t FAN_OUT = 64;
+
+std::atomic<size_t> completed{0};
+std::atomic<uint64_t> sink{0};
+
+void work() {
+    uint64_t value = completed.load(std::memory_order_relaxed);
+    for (int i = 0; i < 200; ++i) {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    sink.fetch_add(value & 1, std::memory_order_relaxed);
+    completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void waitFor(size_t tasks) {
+    while (completed.load(std::memory_order_relaxed) < tasks) {
+        std::this_thread::yield();
+    }
+}
+
+// Tasks per second for one workload on a freshly built pool
+template<typename Pool>
+double measure(size_t threads, size_t tasks, bool spawned) {
+    Pool pool(threads);
+    completed = 0;
+    auto start = Clock::now();
+
+    if (spawned) {
+        Pool* target = &pool;
+        for (size_t i = 0; i < tasks / FAN_OUT; ++i) {
+            pool.enqueue([target] {
+                for (size_t j = 1; j < FAN_OUT; ++j) {
+                    target->enqueue(work);
+                }
+                work();
+            });
+        }
+        waitFor(tasks / FAN_OUT * FAN_OUT);
+    } else {
+        for (size_t i = 0; i < tasks; ++i) {
+            pool.enqueue(work);
+        }
+        waitFor(tasks);
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(completed.load()) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    std::cout << "Tasks/s (millions), " << std::thread::hardware_concurrency() << " hardware threads\n"
+              << "threads | injected: pool / stealing | spawned: pool / stealing\n"
+              << std::fixed << std::setprecision(2);
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        double poolInjected = measure<ThreadPool>(threads, tasks, false) / 1e6;
+        double stealingInjected = measure<WorkStealingPool>(threads, tasks, false) / 1e6;
+        double poolSpawned = measure<ThreadPool>(threads, tasks, true) / 1e6;
+        double stealingSpawned = measure<WorkStealingPool>(threads, tasks, true) / 1e6;
+
+        std::cout << std::setw(7) << threads << " | " << std::setw(14) << poolInjected << " / " << std::setw(8)
+                  << stealingInjected << " | " << std::setw(13) << poolSpawned << " / " << std::setw(8)
+                  << stealingSpawned << "\n";
+    }
+    return sink.load() == 42 ? 1 : 0;  // Keeps the work from being optimized out
+}
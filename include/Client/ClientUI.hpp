@@ -47,6 +47,7 @@ private:
     void printSuccess(const std::string& msg);
     void promptAndWait();
     void printUserList(const std::string& userListData);
+    void printHistoryEntry(const ServerEventData& event);
     
     // Menu commands
     void cmdSendMessage(bool broadcast);
@@ -54,6 +55,7 @@ private:
     void cmdReadMessage();
     void cmdListUsers();
     void cmdGetLog();
+    void cmdHistory();
     
     // Server events management
     void displayEvent(const ServerEventData& event);
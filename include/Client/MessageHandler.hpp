@@ -13,6 +13,13 @@
 #include <chrono>
 #include <atomic>
 #include <optional>
+#include <cstdint>
+#ifdef ENABLE_COROUTINES
+#include "Utils/Coroutine.hpp"
+#include <future>
+
+namespace Utils { class IoLoop; }
+#endif
 
 /**
  * @struct ReceivedMessage
@@ -38,7 +45,9 @@ enum class ServerEvent {
     ERROR_MSG,
     USERS,
     LOG,
-    PING
+    PING,
+    HISTORY,
+    HISTORY_END
 };
 
 /**
@@ -63,8 +72,9 @@ public:
     // Command sending
     bool sendMessage(const std::string& to, const std::string& subject, const std::string& body);
     bool sendCommand(const std::string& command);
+    bool requestHistory(uint64_t start, int count);
     
-    // Listen (blocking)
+    // Listen (blocking; runs as a coroutine on its own I/O loop in coroutine builds)
     void listen(EventCallback onEvent);
     
     // Stored messages management
@@ -80,6 +90,10 @@ public:
 
 private:
     std::optional<ServerEventData> parseMessage(const std::string& raw);
+    void handleFrame(const std::string& raw, const EventCallback& onEvent);
+#ifdef ENABLE_COROUTINES
+    Utils::Detached listenAsync(Utils::IoLoop& loop, EventCallback onEvent, std::promise<void> done);
+#endif
     void storeMessage(const ServerEventData& data);
     
     int socketFd;
@@ -6,13 +6,16 @@
 #ifndef ADMIN_COMMAND_HANDLER_HPP
 #define ADMIN_COMMAND_HANDLER_HPP
 
+#include "Server/Message.hpp"
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <map>
 #include <functional>
+#include <memory>
 
 class Server;
+class Session;
 
 /**
  * @struct AdminCommand
@@ -53,11 +56,14 @@ private:
     void cmdSet(const std::vector<std::string>& args);
     void cmdConfig(const std::vector<std::string>& args);
     void cmdReset(const std::vector<std::string>& args);
+    void cmdLogLevel(const std::vector<std::string>& args);
     void cmdHelp(const std::vector<std::string>& args);
     void cmdStop(const std::vector<std::string>& args);
+    void cmdUpgrade(const std::vector<std::string>& args);
     
     // Helpers
     bool disconnectUser(const std::string& username, const std::string& reason);
+    Message makeAdminMessage(const std::shared_ptr<Session>& to, const std::string& subject, const std::string& body);
     void initializeCommands();
     
     Server* server;
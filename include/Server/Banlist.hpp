@@ -0,0 +1,102 @@
+/**
+ * @file Banlist.hpp
+ * @brief Banned usernames: append-only journal and lock-free lookups
+ */
+
+#ifndef BANLIST_HPP
+#define BANLIST_HPP
+
+#include "Utils/FlatHashMap.hpp"
+#include "Utils/Rcu.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @class Banlist
+ * @brief Set of banned users persisted as a snapshot plus a journal
+ *
+ * The snapshot file keeps one username per line. Every ban or unban appends a
+ * "+user" or "-user" line to <path>.journal, which is replayed over the
+ * snapshot at load time and folded back into it (compaction) once it grows
+ * as large as the list itself. The set is split in 1024 copy-on-write shards
+ * published through RCU: contains() takes no lock, and a change only copies
+ * one shard.
+ */
+class Banlist {
+public:
+    /**
+     * @brief Constructor
+     * @param path Snapshot file (the journal is path + ".journal")
+     */
+    explicit Banlist(std::string path);
+
+    /**
+     * @brief Destructor (closes the journal)
+     */
+    ~Banlist();
+
+    Banlist(const Banlist&) = delete;
+    Banlist& operator=(const Banlist&) = delete;
+
+    /**
+     * @brief Loads the snapshot and replays the journal
+     * @return true if the journal could be opened for appending
+     */
+    bool load();
+
+    /**
+     * @brief Bans a user
+     * @param username User to ban
+     * @return false if the user was already banned
+     */
+    bool add(const std::string& username);
+
+    /**
+     * @brief Lifts a ban
+     * @param username User to unban
+     * @return false if the user was not banned
+     */
+    bool remove(const std::string& username);
+
+    /**
+     * @brief Checks if a user is banned (lock-free)
+     * @param username User to check
+     * @return true if banned
+     */
+    bool contains(const std::string& username) const;
+
+    /**
+     * @brief Number of banned users
+     */
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Rewrites the snapshot and empties the journal
+     * @return true on success
+     */
+    bool compact();
+
+private:
+    static constexpr size_t SHARDS = 1024;
+    using Shard = Utils::FlatHashSet<std::string>;
+
+    static size_t shardOf(const std::string& username);
+    bool update(const std::string& username, bool banned);
+    void appendJournal(char op, const std::string& username);
+    bool compactLocked();
+
+    std::string path;
+    std::string journalPath;
+    int journalFd = -1;
+    size_t journalEntries = 0;
+    std::atomic<size_t> count{0};
+
+    mutable Utils::RcuDomain rcu;
+    std::array<std::unique_ptr<Utils::RcuPtr<Shard>>, SHARDS> shards;
+    std::mutex writeMutex;
+};
+
+#endif
@@ -10,12 +10,13 @@
 #include <string>
 
 class Server;
+struct Message;
 
 /**
  * @class CommandHandler
  * @brief Processes commands received from clients
  * 
- * Handles CONNECT, DISCONNECT, SEND, PING, PONG, LIST_USERS, GET_LOG
+ * Handles CONNECT, DISCONNECT, SEND, PING, PONG, LIST_USERS, GET_LOG, HISTORY
  */
 class CommandHandler {
 public:
@@ -41,8 +42,11 @@ public:
     
     /**
      * @brief Handles message sending
-     * @param parsedData Parsed data [SEND, to, subject, body, timestamp]
+     * @param parsedData Parsed data [SEND, to, subject, body, options...]
      * @param socket Sender socket
+     * 
+     * Optional trailing fields: ttl=<seconds> (drop if not delivered in time),
+     * delay=<seconds> or at=<unix time> (deliver later).
      */
     void handleSendMessage(const std::vector<std::string>& parsedData, int socket);
     
@@ -69,13 +73,38 @@ public:
     
     /**
      * @brief Handles log request
-     * @param parsedData Parsed data [GET_LOG]
+     * @param parsedData Parsed data [GET_LOG, cursor?]
      * @param socket Client socket
+     * 
+     * Replies LOG;lines;cursor with the last LOG_PAGE_LINES lines before the
+     * cursor (none: the end of the log), read backward from the end of the
+     * segment and continued in older segments. The cursor of the previous
+     * page is empty on the oldest one.
      */
-    void handleGetLog(const std::vector<std::string>& parsedData, int socket);    CommandHandler(const CommandHandler&) = delete;
+    void handleGetLog(const std::vector<std::string>& parsedData, int socket);
+    
+    /**
+     * @brief Handles a history request
+     * @param parsedData Parsed data [HISTORY, seq, start, count] or [HISTORY, time, from, to, count, cursor?]
+     * @param socket Client socket
+     * 
+     * Replies with one HISTORY;seq;from;to;subject;body;timestamp frame per
+     * message, then HISTORY_END;nextSeq;count (nextSeq is 0 on the last page).
+     * A start of 0 returns the latest messages.
+     */
+    void handleHistory(const std::vector<std::string>& parsedData, int socket);    CommandHandler(const CommandHandler&) = delete;
     CommandHandler& operator=(const CommandHandler&) = delete;
 
 private:
+    /**
+     * @brief Applies the optional SEND fields to a message
+     * @param parsedData Parsed data [SEND, to, subject, body, options...]
+     * @param msg Message to update (deliverAt, expiresAt)
+     * @param error Error message if an option is invalid
+     * @return true if all options are valid
+     */
+    bool parseSendOptions(const std::vector<std::string>& parsedData, Message& msg, std::string& error);
+    
     /**
      * @brief Sends a raw response to the client
      * @param socket Client socket
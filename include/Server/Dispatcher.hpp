@@ -1,6 +1,6 @@
 /**
  * @file Dispatcher.hpp
- * @brief Message dispatcher with queue and batch processing
+ * @brief Message dispatcher with priority classes and fair mailboxes
  */
 
 #ifndef DISPATCHER_HPP
@@ -8,18 +8,65 @@
 
 #include "Server/Message.hpp"
 #include "Server/DispatcherConfig.hpp"
-#include <queue>
+#include "Utils/TimerWheel.hpp"
+#include <array>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 
+struct ConfigSnapshot;
+
 class Server;
+class Session;
+class OfflineStore;
+
+/**
+ * @struct DispatcherClassStats
+ * @brief Counters of one priority class
+ */
+struct DispatcherClassStats {
+    size_t depth = 0;         ///< Messages currently queued
+    size_t mailboxes = 0;     ///< Recipients with pending messages
+    size_t bytes = 0;         ///< Memory charged by queued messages
+    size_t enqueued = 0;      ///< Messages accepted since startup
+    size_t delivered = 0;     ///< Messages delivered since startup
+    size_t dropped = 0;       ///< Messages rejected or dropped by the queue policy
+    size_t expired = 0;       ///< Messages whose TTL elapsed before delivery
+    double avgLatencyMs = 0;  ///< Average queue-to-delivery latency
+    double maxLatencyMs = 0;  ///< Worst queue-to-delivery latency
+};
+
+/**
+ * @struct DispatcherStats
+ * @brief Snapshot of the dispatcher counters, indexed by MessagePriority
+ */
+struct DispatcherStats {
+    std::array<DispatcherClassStats, MESSAGE_PRIORITY_COUNT> classes;
+    size_t totalQueued = 0;
+    size_t queuedBytes = 0;                 ///< Memory charged by all queued messages
+    size_t maxQueuedBytes = 0;              ///< Current global budget
+    size_t maxQueuedBytesPerRecipient = 0;  ///< Current per-recipient budget
+    size_t scheduled = 0;                   ///< Messages waiting for their delivery time
+    size_t pendingTimers = 0;               ///< Armed TTL and delivery timers
+};
 
 /**
  * @class Dispatcher
- * @brief Manages message queue and delivery
+ * @brief Manages message queues and delivery
  * 
- * Thread-safe. Processes messages in batches for optimized performance.
+ * Thread-safe. Messages are grouped by priority class (admin, direct,
+ * broadcast) served in strict priority order. Inside a class, every
+ * recipient owns a mailbox and mailboxes are served by deficit round-robin,
+ * so a single busy recipient or a large fan-out cannot starve the others.
+ * Queue limits are expressed in bytes (global and per recipient) and taken
+ * from RuntimeConfig through a change subscription, so /set applies them
+ * immediately. Scheduled deliveries
+ * and message TTLs are driven by a hierarchical timing wheel. Messages whose
+ * recipient is offline go to the server's OfflineStore.
  */
 class Dispatcher {
 public:
@@ -31,29 +78,142 @@ public:
      */
     explicit Dispatcher(Server* attributedServer);
     
+    ~Dispatcher();
+    
     /**
-     * @brief Adds a message to the queue
+     * @brief Adds a message to its recipient's mailbox
      * @param msg Message to send
      * @return true if added, false if queue full
      */
     bool queueMessage(const Message& msg);
     
+    /**
+     * @brief Queues the messages stored for a user who just connected
+     * @param session Session of the user
+     * @return Number of messages queued
+     */
+    size_t deliverStored(const std::shared_ptr<Session>& session);
+    
     /**
      * @brief Main processing loop (blocking)
      */
     void run();
-      /**
+    
+    /**
      * @brief Stops the dispatcher gracefully
      */
     void stop();
+    
+    /**
+     * @brief Pauses deliveries and waits for the one in progress to finish
+     */
+    void suspend();
+    
+    /**
+     * @brief Resumes deliveries after suspend()
+     */
+    void resume();
+    
+    /**
+     * @brief Moves every queued and scheduled message to the offline store
+     * @param store Destination store
+     * @return Number of messages moved
+     *
+     * Called while suspended, before the process hands its clients over.
+     * Scheduled messages lose their delivery time and are delivered on the
+     * next deliverStored() of their recipient.
+     */
+    size_t spill(OfflineStore& store);
+    
+    /**
+     * @brief Gets queue depth and latency counters per priority class
+     * @return Statistics snapshot
+     */
+    DispatcherStats getStats();
+    
+    /**
+     * @brief Converts a priority class to a display name
+     * @param priority Priority class
+     * @return Class name
+     */
+    static const char* priorityName(MessagePriority priority);
 
 private:
-    std::queue<Message> messages;
+    /**
+     * @struct QueuedMessage
+     * @brief Mailbox entry (address stays stable while queued)
+     */
+    struct QueuedMessage {
+        Message msg;
+        uint64_t expiryTimer = 0;  ///< TTL timer id (0 = none)
+        bool expired = false;      ///< TTL fired; skipped when reached
+    };
+    
+    /**
+     * @struct TimerTask
+     * @brief Payload of a dispatcher timer: either a TTL or a scheduled delivery
+     */
+    struct TimerTask {
+        QueuedMessage* expiring = nullptr;   ///< Entry whose TTL elapsed
+        std::unique_ptr<Message> scheduled;  ///< Message whose delivery time arrived
+    };
+    
+    /**
+     * @struct Mailbox
+     * @brief Pending messages of one recipient inside a class
+     */
+    struct Mailbox {
+        std::deque<QueuedMessage> messages;
+        size_t deficit = 0;
+    };
+    
+    /**
+     * @struct PriorityClass
+     * @brief Mailboxes of one class and their round-robin order
+     */
+    struct PriorityClass {
+        std::unordered_map<std::string, Mailbox> mailboxes;
+        std::deque<std::string> activeOrder;
+        size_t depth = 0;
+        size_t bytes = 0;
+        DispatcherClassStats stats;
+        double totalLatencyMs = 0;
+    };
+    
+    void loadLimits(const ConfigSnapshot& settings);
+    bool enqueueLocked(const Message& msg);
+    bool evictOldest(const Message& incoming, bool recipientOnly);
+    void releaseBytes(PriorityClass& cls, const Message& msg);
+    void purgeExpired(Mailbox& mailbox);
+    void onTimer(TimerTask&& task);
+    void notifySender(const Message& msg, const std::string& reason);
+    void handleUndelivered(const Message& msg);
+    bool popNext(Message& out);
+    void recordDelivery(const Message& msg);
+    void recordHistory(const Message& msg);
+    
+    std::array<PriorityClass, MESSAGE_PRIORITY_COUNT> classes;
+    size_t totalQueued = 0;
+    size_t queuedBytes = 0;
+    std::unordered_map<std::string, size_t> recipientBytes;
+    Utils::TimerWheel<TimerTask> timers;
+    size_t scheduledCount = 0;
+    size_t scheduledBytes = 0;
+    bool timersChanged = false;  ///< A timer was armed: the run loop must recompute its deadline
+    std::vector<std::pair<std::shared_ptr<Session>, std::string>> pendingNotices;
+    std::vector<std::pair<std::string, uint64_t>> pendingAcks;
     Server* attributedServer;
     DispatcherConfig config;
+    size_t configSubscription = 0;
     std::mutex messagesMutex;
+    std::mutex deliveryMutex;  ///< Held by run() from pop to delivery; suspend() waits on it
     std::condition_variable cv;
     bool running = true;
+    bool suspended = false;
+    
+    std::mutex historyMutex;
+    std::condition_variable historyCv;
+    size_t pendingHistory = 0;  ///< History writes queued on the worker pool
 };
 
-#endif
\ No newline at end of file
+#endif
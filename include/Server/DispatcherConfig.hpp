@@ -7,6 +7,7 @@
 #define DISPATCHER_CONFIG_HPP
 
 #include <chrono>
+#include <cstddef>
 
 /**
  * @enum QueueFullPolicy
@@ -25,8 +26,11 @@ enum class QueueFullPolicy {
 struct DispatcherConfig {
     int delayBetweenMessages = 10;              ///< Delay between messages (ms)
     std::chrono::milliseconds startedTimestamp; ///< Startup timestamp
-    int maxStoredMessages = 10000;              ///< Max queue size
+    int maxStoredMessages = 10000;              ///< Max queue size (MAX_QUEUE_SIZE)
+    size_t maxQueuedBytes = 256 * 1024 * 1024;  ///< Global queue budget (MAX_QUEUE_KB)
+    size_t maxQueuedBytesPerRecipient = 32 * 1024 * 1024; ///< Per-recipient budget (MAX_QUEUE_KB_PER_USER)
     QueueFullPolicy queuePolicy = QueueFullPolicy::REJECT; ///< Full queue policy
+    size_t mailboxQuantum = 4096;               ///< Deficit round-robin quantum per mailbox (bytes)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file EventLoop.hpp
+ * @brief epoll readiness loop and incremental frame decoding for idle-heavy servers
+ */
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class EventLoop
+ * @brief Watches client sockets with epoll so idle connections hold no thread
+ *
+ * Sockets are registered one-shot: once a socket is reported readable it is
+ * not reported again until rearm(), so exactly one task at a time reads and
+ * handles its frames, in order. Bytes of an incomplete frame are kept in a
+ * per-socket buffer that is released as soon as the frame completes, so an
+ * idle connection costs one empty std::string here. Sockets stay in blocking
+ * mode (the send paths rely on it); reads use MSG_DONTWAIT.
+ */
+class EventLoop {
+public:
+    /**
+     * @enum ReadStatus
+     * @brief Outcome of read()
+     */
+    enum class ReadStatus {
+        OPEN,    ///< Connection still usable
+        CLOSED,  ///< Peer closed, read error or malformed frame
+        GONE     ///< Descriptor already closed elsewhere
+    };
+
+    EventLoop() = default;
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Creates the epoll instance
+     * @param wakeupFd Descriptor that interrupts wait() while readable (-1 for none)
+     * @return true on success
+     */
+    bool open(int wakeupFd);
+
+    /**
+     * @brief Starts watching a connection
+     * @param socket Client socket (its buffered bytes, if any, are dropped)
+     * @return true on success
+     */
+    bool add(int socket);
+
+    /**
+     * @brief Reports the socket again once it is readable (after a read())
+     * @return false if the socket is no longer watched
+     */
+    bool rearm(int socket);
+
+    /**
+     * @brief Blocks until sockets are readable
+     * @param ready Receives the readable sockets (cleared first)
+     * @return true if the wakeup descriptor is readable
+     */
+    bool wait(std::vector<int>& ready);
+
+    /**
+     * @brief Reads what the socket has and extracts the complete frames
+     * @param socket Socket reported by wait()
+     * @param frames Receives the frames, without their length prefix
+     * @return Connection state after the read
+     */
+    ReadStatus read(int socket, std::vector<std::string>& frames);
+
+    /**
+     * @brief Drops the buffered bytes of a socket about to be closed
+     */
+    void forget(int socket);
+
+    /**
+     * @brief Checks whether part of a frame is buffered for a socket
+     */
+    bool hasPartialFrame(int socket) const;
+
+private:
+    static constexpr size_t BUFFER_CHUNK = 4096;
+    static constexpr size_t BUFFER_CHUNKS = 1024;  // Sockets up to 4M
+    using BufferChunk = std::array<std::string, BUFFER_CHUNK>;
+
+    std::string* buffer(int socket, bool create);
+    const std::string* buffer(int socket) const;
+
+    int epollFd = -1;
+    int wakeupFd = -1;
+
+    // Each buffer is only touched by the task that owns its socket (one-shot)
+    std::array<std::atomic<BufferChunk*>, BUFFER_CHUNKS> buffers{};
+    std::mutex chunkMutex;
+};
+
+#endif
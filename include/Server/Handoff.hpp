@@ -0,0 +1,116 @@
+/**
+ * @file Handoff.hpp
+ * @brief Unix socket channel passing the server sockets to a new process
+ */
+
+#ifndef HANDOFF_HPP
+#define HANDOFF_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct HandoffClient
+ * @brief One client connection handed over, with its session state
+ */
+struct HandoffClient {
+    int socket = -1;              ///< Connection file descriptor
+    std::string username;         ///< Empty if the client has not sent CONNECT yet
+    int64_t idleMs = 0;           ///< Time since the last frame received (ms)
+    bool waitingForPong = false;  ///< A PING is outstanding
+};
+
+/**
+ * @struct HandoffState
+ * @brief Everything a new process needs to take over the running server
+ */
+struct HandoffState {
+    int listenSocket = -1;
+    std::vector<HandoffClient> clients;
+};
+
+/**
+ * @class HandoffChannel
+ * @brief SOCK_SEQPACKET Unix socket between the old and the new server process
+ *
+ * The old process listens, the new one connects and sends HELLO once it is
+ * ready to serve. The old process then sends the listening socket and every
+ * client socket as SCM_RIGHTS ancillary data, in batches of at most
+ * Constants::HANDOFF_BATCH_FDS descriptors, each described by one text line
+ * ("LISTEN" or "CLIENT;<user>;<pong age ms>;<waiting 0|1>"); "END" closes the
+ * transfer. The new process answers READY once it owns the sockets.
+ */
+class HandoffChannel {
+public:
+    HandoffChannel() = default;
+
+    /**
+     * @brief Destructor (closes the sockets and removes the listening path)
+     */
+    ~HandoffChannel();
+
+    HandoffChannel(const HandoffChannel&) = delete;
+    HandoffChannel& operator=(const HandoffChannel&) = delete;
+
+    /**
+     * @brief Binds the channel (old process side)
+     * @param path Unix socket path (replaced if it exists)
+     * @return true on success
+     */
+    bool listen(const std::string& path);
+
+    /**
+     * @brief Waits for the new process to connect
+     * @param timeoutMs Max wait (ms)
+     * @return true once connected
+     */
+    bool accept(int timeoutMs);
+
+    /**
+     * @brief Connects to a listening channel (new process side)
+     * @param path Unix socket path
+     * @return true on success
+     */
+    bool connect(const std::string& path);
+
+    /**
+     * @brief Sends a control word (HELLO, READY)
+     * @param word Text to send
+     * @return true on success
+     */
+    bool sendWord(const std::string& word);
+
+    /**
+     * @brief Receives a control word
+     * @param timeoutMs Max wait (ms)
+     * @return Text, or std::nullopt on timeout or error
+     */
+    std::optional<std::string> receiveWord(int timeoutMs);
+
+    /**
+     * @brief Sends the sockets and their session state
+     * @param state Descriptors stay open in the sender
+     * @return true if every batch was sent
+     */
+    bool sendState(const HandoffState& state);
+
+    /**
+     * @brief Receives the sockets and their session state
+     * @param state Filled with the new descriptors
+     * @param timeoutMs Max wait for each batch (ms)
+     * @return true once END was received
+     */
+    bool receiveState(HandoffState& state, int timeoutMs);
+
+private:
+    bool waitReadable(int fd, int timeoutMs);
+    bool sendBatch(const std::string& text, const std::vector<int>& fds);
+
+    std::string path;
+    int listenFd = -1;
+    int fd = -1;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file HistoryStore.hpp
+ * @brief Per-user message history in memory-mapped segment files
+ */
+
+#ifndef HISTORY_STORE_HPP
+#define HISTORY_STORE_HPP
+
+#include "Server/Message.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * @struct HistoryEntry
+ * @brief One message of a user's history
+ */
+struct HistoryEntry {
+    uint64_t seq = 0;        ///< Per-user sequence number (starts at 1)
+    std::string from;
+    std::string to;
+    std::string subject;
+    std::string body;
+    int64_t timestamp = 0;   ///< Unix time of the message (s)
+};
+
+/**
+ * @struct HistoryPage
+ * @brief Result of a history query
+ */
+struct HistoryPage {
+    std::vector<HistoryEntry> entries;
+    uint64_t nextSeq = 0;    ///< Cursor for the next page (0 if the query is exhausted)
+};
+
+/**
+ * @class HistoryStore
+ * @brief Keeps the messages sent and received by each user
+ *
+ * Each user owns a directory of segments named after their first sequence
+ * number: a .dat file of length-prefixed records and a .idx file of fixed-size
+ * {seq, timestamp, offset, length} entries. Sequence numbers are dense, so a
+ * sequence lookup is an array access in the index; timestamps are kept
+ * non-decreasing in the index, so a time range is a binary search. Queries map
+ * the files read-only and decode only the requested records, so they are
+ * served from the page cache. Thread-safe (one lock per user).
+ */
+class HistoryStore {
+public:
+    /**
+     * @brief Constructor
+     * @param directory Root directory of the per-user histories
+     */
+    explicit HistoryStore(std::string directory);
+
+    /**
+     * @brief Destructor (closes the open segments)
+     */
+    ~HistoryStore();
+
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    /**
+     * @brief Creates the root directory
+     * @return true on success
+     */
+    bool open();
+
+    /**
+     * @brief Appends a message to a user's history
+     * @param owner User whose history receives the message (sender or recipient)
+     * @param msg Message to record
+     */
+    void record(const std::string& owner, const Message& msg);
+
+    /**
+     * @brief Reads a page of history by sequence number
+     * @param owner User
+     * @param start First sequence number (0 = the latest @p count messages)
+     * @param count Maximum number of entries
+     * @return Entries in sequence order
+     */
+    HistoryPage bySequence(const std::string& owner, uint64_t start, size_t count);
+
+    /**
+     * @brief Reads a page of history by time range
+     * @param owner User
+     * @param from Start of the range (unix time, inclusive)
+     * @param to End of the range (unix time, inclusive)
+     * @param count Maximum number of entries
+     * @param fromSeq Skip entries below this sequence number (nextSeq of the previous page)
+     * @return Entries in sequence order
+     */
+    HistoryPage byTime(const std::string& owner, int64_t from, int64_t to, size_t count, uint64_t fromSeq = 0);
+
+    /**
+     * @brief Closes the files of a user (called when they disconnect)
+     * @param owner User
+     */
+    void release(const std::string& owner);
+
+private:
+    /**
+     * @struct IndexRecord
+     * @brief Entry of a .idx file
+     */
+    struct IndexRecord {
+        uint64_t seq;
+        int64_t timestamp;   ///< Clamped to be non-decreasing within a user
+        uint32_t offset;     ///< Offset of the record in the .dat file
+        uint32_t length;
+    };
+    static_assert(sizeof(IndexRecord) == 24, "IndexRecord is written to disk as is");
+
+    /**
+     * @struct Segment
+     * @brief A .dat/.idx pair
+     */
+    struct Segment {
+        uint64_t firstSeq;
+        uint64_t count;
+        uint64_t dataSize;
+        int64_t lastTimestamp;
+    };
+
+    /**
+     * @struct UserHistory
+     * @brief Segments and open files of one user
+     */
+    struct UserHistory {
+        std::mutex mutex;
+        bool loaded = false;
+        std::vector<Segment> segments;
+        int dataFd = -1;
+        int indexFd = -1;
+    };
+
+    class MappedSegment;
+
+    UserHistory& getUser(const std::string& owner);
+    bool load(const std::string& owner, UserHistory& user);
+    bool openActive(const std::string& owner, UserHistory& user);
+    void closeFiles(UserHistory& user);
+    std::string segmentPath(const std::string& owner, uint64_t firstSeq, const char* extension) const;
+    static bool readRange(const MappedSegment& mapped, uint64_t firstIndex, int64_t maxTimestamp,
+                          size_t count, HistoryPage& page);
+
+    std::string directory;
+    std::unordered_map<std::string, std::unique_ptr<UserHistory>> users;
+    std::mutex usersMutex;
+};
+
+#endif
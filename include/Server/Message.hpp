@@ -8,6 +8,23 @@
 
 #include <string>
 #include <chrono>
+#include <cstddef>
+#include <memory>
+#include <cstdint>
+
+class Session;
+
+/**
+ * @enum MessagePriority
+ * @brief Delivery class of a message (lower value = served first)
+ */
+enum class MessagePriority {
+    ADMIN,     ///< Server announcements and admin messages
+    DIRECT,    ///< User to user messages
+    BROADCAST  ///< Per-recipient copies of a user broadcast
+};
+
+constexpr size_t MESSAGE_PRIORITY_COUNT = 3; ///< Number of priority classes
 
 /**
  * @struct Message
@@ -19,11 +36,30 @@ struct Message {
     std::string subject;   ///< Message subject
     std::string body;      ///< Message body
     std::chrono::system_clock::time_point timestamp; ///< Send date
+    MessagePriority priority = MessagePriority::DIRECT; ///< Delivery class
+    std::chrono::steady_clock::time_point queuedAt;  ///< Time of entry in the dispatcher
+    std::chrono::steady_clock::time_point deliverAt{}; ///< Scheduled delivery (epoch = immediate)
+    std::chrono::steady_clock::time_point expiresAt{}; ///< Delivery deadline (epoch = no TTL)
+    uint64_t storeSeq = 0;               ///< Offline store record (0 = not stored)
+    std::shared_ptr<Session> sender;     ///< Sender session resolved at enqueue (null for admin)
+    std::shared_ptr<Session> recipient;  ///< Recipient session resolved at enqueue
     
     /**
      * @brief Default constructor (timestamp = now)
      */
     Message() : timestamp(std::chrono::system_clock::now()) {}
+    
+    /**
+     * @brief Size of the payload, used as scheduling cost
+     * @return Number of bytes of the text fields
+     */
+    size_t payloadSize() const { return from.size() + to.size() + subject.size() + body.size(); }
+    
+    /**
+     * @brief Approximate memory held by the message while queued
+     * @return Number of bytes charged to the queue budgets
+     */
+    size_t queuedSize() const { return sizeof(Message) + payloadSize(); }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file OfflineStore.hpp
+ * @brief Durable mailbox for offline users (append-only segmented log)
+ */
+
+#ifndef OFFLINE_STORE_HPP
+#define OFFLINE_STORE_HPP
+
+#include "Server/Message.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+/**
+ * @struct OfflineStoreStats
+ * @brief Counters of the offline store
+ */
+struct OfflineStoreStats {
+    size_t pending = 0;        ///< Messages waiting for their recipient
+    size_t recipients = 0;     ///< Users with at least one stored message
+    size_t segments = 0;       ///< Segment files on disk
+    uint64_t diskBytes = 0;    ///< Total size of the segment files
+    double recoveryMs = 0;     ///< Time spent rebuilding the index at startup
+    size_t recovered = 0;      ///< Pending messages found at startup
+    uint64_t syncs = 0;        ///< Group commits (fdatasync calls) performed
+    uint64_t syncedRecords = 0; ///< Records made durable by those commits
+    uint64_t storedBytes = 0;  ///< Size of the pending records, charged to the budgets
+    uint64_t rejected = 0;     ///< Messages refused by the budgets
+    uint64_t expired = 0;      ///< Pending messages removed by the expiry sweep
+};
+
+/**
+ * @class OfflineStore
+ * @brief Stores messages for disconnected users until they come back
+ *
+ * Messages are appended to numbered segment files (segment-XXXXXXXX.log) as
+ * checksummed STORE records; a delivered message is retired by an ACK record.
+ * Appends are buffered and written in batches by a single writer thread. An
+ * in-memory per-recipient index points at the records, and is rebuilt by
+ * scanning the segments at startup. A segment is deleted once it and every
+ * older segment hold no pending message. Thread-safe.
+ *
+ * Mail for offline users is bounded: OFFLINE_MAX_KB_PER_USER per recipient
+ * and OFFLINE_MAX_MB in total, and a message without its own ttl= expires
+ * after OFFLINE_TTL_H (the writer sweeps expired mail every
+ * OFFLINE_EXPIRY_SWEEP_S), so mail for names that never connect goes away.
+ *
+ * sync() gives group commit: callers waiting for durability share a single
+ * fdatasync, issued by the writer once the batch has grown for at most
+ * GROUP_COMMIT_DELAY_MS or reached GROUP_COMMIT_MAX_BYTES.
+ */
+class OfflineStore {
+public:
+    /**
+     * @brief Constructor
+     * @param directory Directory holding the segment files
+     */
+    explicit OfflineStore(std::string directory);
+
+    /**
+     * @brief Destructor (flushes and stops the writer)
+     */
+    ~OfflineStore();
+
+    OfflineStore(const OfflineStore&) = delete;
+    OfflineStore& operator=(const OfflineStore&) = delete;
+
+    /**
+     * @brief Creates the directory, recovers the index and starts the writer
+     * @return true on success
+     */
+    bool open();
+
+    /**
+     * @brief Flushes pending appends and stops the writer
+     */
+    void close();
+
+    /**
+     * @brief Stores a message for its recipient (msg.to)
+     *
+     * Messages not in flight are refused once the recipient's or the
+     * store's budget would be exceeded.
+     * @param msg Message to store
+     * @param inFlight true if the caller delivers it now (takePending() skips it)
+     * @param rejection Set to the exhausted budget when refused (optional)
+     * @return Sequence number of the record (0 on failure)
+     */
+    uint64_t append(const Message& msg, bool inFlight = false, std::string* rejection = nullptr);
+
+    /**
+     * @brief Loads the pending messages of a user, in order, and marks them in flight
+     * @param username Recipient
+     * @return Messages with storeSeq set
+     */
+    std::vector<Message> takePending(const std::string& username);
+
+    /**
+     * @brief Puts an in-flight message back to pending (delivery failed)
+     * @param username Recipient
+     * @param seq Sequence number
+     */
+    void release(const std::string& username, uint64_t seq);
+
+    /**
+     * @brief Retires a message (delivered or expired)
+     * @param username Recipient
+     * @param seq Sequence number
+     */
+    void acknowledge(const std::string& username, uint64_t seq);
+
+    /**
+     * @brief Waits until every appended record has been written
+     */
+    void flush();
+
+    /**
+     * @brief Waits until every appended record is on stable storage
+     * @return true if the records were written and synced
+     */
+    bool sync();
+
+    /**
+     * @brief Gets the store counters
+     * @return Statistics snapshot
+     */
+    OfflineStoreStats getStats();
+
+private:
+    enum class RecordType : uint8_t { STORE = 1, ACK = 2 };
+    enum class EntryState : uint8_t { PENDING, IN_FLIGHT, ACKED };
+
+    /**
+     * @struct Entry
+     * @brief Location of a stored message in the log
+     */
+    struct Entry {
+        uint64_t seq;
+        uint32_t segment;
+        uint32_t length;
+        uint64_t offset;
+        EntryState state;
+        int64_t expiresAtMs;  ///< Unix time (0 = no TTL)
+    };
+
+    /**
+     * @struct Segment
+     * @brief A segment file and the number of its messages still pending
+     */
+    struct Segment {
+        uint32_t id;
+        uint64_t size;
+        size_t live;
+    };
+
+    /**
+     * @struct Chunk
+     * @brief Encoded records waiting to be written to one segment
+     */
+    struct Chunk {
+        uint32_t segment;
+        std::string data;
+    };
+
+    std::string segmentPath(uint32_t id) const;
+    bool recover();
+    size_t recoverSegment(uint32_t id, uint64_t& validSize);
+    void appendRecord(RecordType type, const std::string& payload, uint64_t& offset, uint32_t& segment);
+    Entry* findEntry(const std::string& username, uint64_t seq);
+    void acknowledgeLocked(const std::string& username, uint64_t seq);
+    void expireStale();
+    void retire(const std::string& username, Entry& entry);
+    void writerLoop();
+    bool writeChunk(const Chunk& chunk);
+    bool syncDirectory();
+    static bool decodeMessage(const std::string& payload, Message& msg);
+
+    std::string directory;
+    std::unordered_map<std::string, std::deque<Entry>> index;
+    std::deque<Segment> segments;
+    size_t pendingCount = 0;
+    uint64_t storedBytes = 0;
+    std::unordered_map<std::string, uint64_t> recipientBytes;  ///< Pending record bytes per recipient
+    uint64_t rejectedCount = 0;
+    uint64_t expiredCount = 0;
+    uint64_t nextSeq = 1;
+    double recoveryMs = 0;
+    size_t recoveredCount = 0;
+
+    std::vector<Chunk> pendingChunks;
+    std::vector<uint32_t> obsoleteSegments;
+    uint64_t appendedTicket = 0;
+    uint64_t writtenTicket = 0;
+    uint64_t syncRequested = 0;   ///< Highest ticket a sync() caller waits for
+    uint64_t syncedTicket = 0;
+    uint64_t failedTicket = 0;    ///< Highest ticket of a batch that failed to write or sync
+    size_t pendingBytes = 0;
+    uint64_t syncCount = 0;
+    uint64_t syncedRecords = 0;
+    int activeFd = -1;
+    uint32_t activeFdSegment = 0;
+
+    std::mutex storeMutex;
+    std::condition_variable writerCv;
+    std::condition_variable writtenCv;
+    std::thread writer;
+    bool running = false;
+};
+
+#endif
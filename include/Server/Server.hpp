@@ -11,7 +11,21 @@
 #include "Dispatcher.hpp"
 #include "AdminCommandHandler.hpp"
 #include "CommandHandler.hpp"
-#include "Utils/ThreadPool.hpp"
+#include "Session.hpp"
+#include "OfflineStore.hpp"
+#include "HistoryStore.hpp"
+#include "Banlist.hpp"
+#include "Handoff.hpp"
+#include "EventLoop.hpp"
+#include "SessionRegistry.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/ConfigWatcher.hpp"
+#include "Utils/WorkStealingPool.hpp"
+#include "Utils/ThreadPlacement.hpp"
+#include "Utils/TimerWheel.hpp"
+#ifdef ENABLE_COROUTINES
+#include "Utils/IoLoop.hpp"
+#endif
 #include <unordered_map>
 #include <unordered_set>
 
@@ -21,22 +35,12 @@
 #include <memory>
 #include <mutex>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
 
 class AdminCommandHandler;
 class CommandHandler;
-
-/**
- * @struct ClientInfo
- * @brief Complete information of a connected client
- */
-struct ClientInfo {
-    int socket; //File descriptor
-    std::chrono::steady_clock::time_point lastPong; //Last PONG received
-    bool waitingForPong = false;//Waiting for PONG
-    
-    ClientInfo() = default;
-    explicit ClientInfo(int s) : socket(s), lastPong(std::chrono::steady_clock::now()) {}
-};
+struct ConfigSnapshot;
 
 /**
  * @class Server
@@ -72,11 +76,52 @@ public:
      */
     int start(int PORT, int MAX_CONNECTIONS = 0);
     
+    /**
+     * @brief Starts the server with the sockets of a running instance (hot upgrade)
+     * @param channelPath Handoff socket of the old process
+     * @param MAX_CONNECTIONS Max connections (0 = unlimited)
+     * @return 0 on success
+     */
+    int takeover(const std::string& channelPath, int MAX_CONNECTIONS = 0);
+    
+    /**
+     * @brief Hands the listening socket and every client over to a new process
+     * @param binary Executable to start (empty = the running one)
+     * @return false if the upgrade was aborted (this process keeps serving);
+     *         does not return on success
+     */
+    bool upgrade(const std::string& binary = "");
+    
     /**
      * @brief Stops the server and closes all connections
      */
     void stop();
     
+    /**
+     * @brief Serves connections from one epoll loop instead of a pool thread
+     *        per connection, so idle clients hold no thread (call before start)
+     * @param enabled true for the event loop mode
+     */
+    void setEventLoop(bool enabled) { eventLoopMode = enabled; }
+    
+    /**
+     * @brief Sets the CPUs and NUMA node of each server thread (call before start)
+     * @param layout Placement parsed from the command line
+     */
+    void setPlacement(const Utils::ThreadPlacement& layout) { placement = layout; }
+    
+    /**
+     * @brief Config file to watch and reload while running (call before start)
+     * @param path File already applied to RuntimeConfig (empty = none)
+     */
+    void setConfigFile(const std::string& path) { configFile = path; }
+    
+    /**
+     * @brief Closes a client connection (also forgets it in the event loop mode)
+     * @param socket Client socket
+     */
+    void closeClientSocket(int socket);
+    
     /**
      * @brief Executes a client command
      * @param commandName Command name
@@ -100,6 +145,20 @@ public:
      */
     int getUserSocket(const std::string& username);
     
+    /**
+     * @brief Gets a user's session handle
+     * @param username Username
+     * @return Session (nullptr if not connected)
+     */
+    std::shared_ptr<Session> getSession(const std::string& username);
+    
+    /**
+     * @brief Gets the session registered on a socket
+     * @param socket Client socket
+     * @return Session (nullptr if not authenticated)
+     */
+    std::shared_ptr<Session> getSessionBySocket(int socket);
+    
     /**
      * @brief Counts connected clients
      * @return Number of clients
@@ -114,23 +173,24 @@ public:
     bool isUsernameTaken(const std::string& username);
     
     /**
-     * @brief Registers a new client
+     * @brief Registers a new client, unless the name is already connected
      * @param username Client name
      * @param socket Client socket
+     * @return Newly created session (nullptr if the name is taken)
      */
-    void registerClient(const std::string& username, int socket);
+    std::shared_ptr<Session> registerClient(const std::string& username, int socket);
     
     /**
-     * @brief Unregisters a client
+     * @brief Unregisters a client and closes its session
      * @param username Client name
      */
     void unregisterClient(const std::string& username);
     
     /**
-     * @brief Updates a client's last pong timestamp
-     * @param username Client name
+     * @brief Records inbound traffic from a client, which postpones its next PING (lock-free)
+     * @param socket Client socket
      */
-    void updateClientPong(const std::string& username);
+    void touchClient(int socket);
     
     /**
      * @brief Gets username by socket
@@ -147,6 +207,34 @@ public:
      */
     Dispatcher* getDispatcher() { return dispatcher.get(); }
     
+    /**
+     * @brief Gets the offline message store
+     * @return Pointer to the store (nullptr if disabled)
+     */
+    OfflineStore* getOfflineStore() { return offlineStore.get(); }
+    
+    /**
+     * @brief Gets the per-user message history
+     * @return Pointer to the history (nullptr if disabled)
+     */
+    HistoryStore* getHistoryStore() { return historyStore.get(); }
+    
+    /**
+     * @brief Gets the worker pool (frame handling and background persistence)
+     * @return Pool pointer
+     */
+    WorkStealingPool* getThreadPool() { return threadPool.get(); }
+    
+    /**
+     * @brief Checks whether connections are served by the event loop (or by
+     *        coroutines), in which case no pool worker is pinned by a connection
+     */
+#ifdef ENABLE_COROUTINES
+    bool usesEventLoop() const { return eventLoop != nullptr || ioLoop != nullptr; }
+#else
+    bool usesEventLoop() const { return eventLoop != nullptr; }
+#endif
+    
     /**
      * @brief Increments sent messages counter
      */
@@ -163,6 +251,12 @@ public:
      */
     std::unordered_map<std::string, int> getAllClients();
     
+    /**
+     * @brief Gets the sessions of all connected clients
+     * @return Session handles
+     */
+    std::vector<std::shared_ptr<Session>> getAllSessions();
+    
     /**
      * @brief Gets the startup timestamp
      * @return Time point of startup
@@ -210,38 +304,99 @@ public:
 private:
     void initializeConfig(int PORT);
     void initializeCommands();
+    void initializeServices();
+    void openOfflineStore();
     void createServerThreads();
     void acceptClients();
+    void startReader(int clientSocket);
     void handleClientMessages(int clientSocket);
     
-    void heartbeatLoop();
-    void checkClientTimeouts();
+    // Pool size: THREAD_POOL_SIZE (or the autoscaled size) plus one worker
+    // per reader when each connection has its own
+    void resizeThreadPool();
+    void poolMonitorLoop();
     
-    /**
-     * @brief Loads banned users list from file
-     */
-    void loadBanlist();
+    // Subscribed to RuntimeConfig changes while running
+    void onConfigChanged(const ConfigSnapshot& config);
+    void applyLogRotation(const ConfigSnapshot& config);
     
-    /**
-     * @brief Saves banned users list to file
-     */
-    void saveBanlist();    
+    // Event loop mode: a readable socket is handed to one pool task at a time
+    void runEventLoop();
+    void serviceConnection(int clientSocket);
+    
+#ifdef ENABLE_COROUTINES
+    // Coroutine build: handleClientMessages() as a coroutine, waiting on the
+    // I/O loop and running commands on the pool
+    Utils::Detached runConnection(int clientSocket);
+#endif
+    
+    // Hot upgrade
+    static constexpr int PARK_LISTENER = -1;
+    static constexpr int PARK_EVENT_LOOP = -2;
+    bool waitReadable(int socket, bool listener = false);
+    void parkForHandoff(int socket);  ///< A client socket, PARK_LISTENER or PARK_EVENT_LOOP
+    bool suspendForHandoff();
+    void resumeAfterHandoff();
+    HandoffState collectHandoffState();
+    void adoptClient(const HandoffClient& client);
+    
+    // Heartbeat: one timer per client, fired when the client may have gone idle
+    using HeartbeatTimer = std::pair<std::chrono::steady_clock::time_point, std::weak_ptr<ClientInfo>>;
+    void armHeartbeat(const SessionRegistry::Entry& info);
+    void heartbeatLoop();
+    std::vector<HeartbeatTimer> checkIdleClients(std::vector<std::weak_ptr<ClientInfo>>& due);
+
     
     ServerConfig config{.socket = 0, .address = {}, .port = 8080, .max_connections = 0};
 
     // Connected clients: username + complete info (socket + heartbeat)
-    std::unordered_map<std::string, ClientInfo> clients;
-    std::unordered_set<std::string> bannedUsers;
-    std::unordered_map<std::string, CommandHandler> commands;
+    SessionRegistry registry;
+    Banlist banlist;
+    Utils::FlatHashMap<std::string, CommandHandler> commands;
 
+    std::unique_ptr<OfflineStore> offlineStore;
+    std::unique_ptr<HistoryStore> historyStore;
     std::unique_ptr<Dispatcher> dispatcher;
     std::unique_ptr<AdminCommandHandler> adminHandler;
     std::unique_ptr<::CommandHandler> commandHandler;
-    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<WorkStealingPool> threadPool;
+    std::atomic<size_t> poolBaseSize{0};  ///< Written by the pool monitor
+    std::mutex monitorMutex;
+    std::condition_variable monitorCv;    ///< Wakes the pool monitor on a configuration change
+    bool configChanged = false;
+    size_t configSubscription = 0;
+    std::string configFile;
+    std::unique_ptr<Utils::ConfigWatcher> configWatcher;
+    std::unique_ptr<EventLoop> eventLoop;
+    bool eventLoopMode = false;
+#ifdef ENABLE_COROUTINES
+    std::unique_ptr<Utils::IoLoop> ioLoop;  ///< Without the event loop: one coroutine per connection
+#endif
+    Utils::ThreadPlacement placement;
     
-    mutable std::mutex bannedUsersMutex;
-    mutable std::mutex clientsMutex;
+    std::mutex pingMutex;  ///< Held by the heartbeat during a PING round
+
+    // Owned by the heartbeat thread; armHeartbeat() adds the timers of new clients
+    std::mutex heartbeatMutex;
+    std::condition_variable heartbeatCv;
+    Utils::TimerWheel<std::weak_ptr<ClientInfo>> heartbeatTimers{std::chrono::milliseconds(Constants::HEARTBEAT_TICK_MS)};
+    std::chrono::steady_clock::time_point heartbeatDeadline;  ///< Next wakeup of the heartbeat thread
+
+    // Hot upgrade: readers and the accept loop park between frames while
+    // handoffEvent (an eventfd) is readable
+    int handoffEvent = -1;
+    std::atomic<bool> handoffActive{false};
+    std::mutex handoffMutex;
+    std::condition_variable handoffCv;
+    std::unordered_set<int> pendingConnections;  ///< Accepted, reader not started yet
+    std::unordered_set<int> parkedConnections;   ///< Reader parked for the handoff
+    std::unordered_set<int> eventConnections;    ///< Served by the event loop
+    std::unordered_set<int> closingConnections;  ///< Event loop sockets shut down, closed by their next task
+    bool eventLoopParked = false;
+    size_t runningReaders = 0;
+    bool listenerParked = false;
 
+    std::atomic<uint64_t> nextSessionGeneration{1};
     size_t totalMessagesSent = 0;
     size_t totalMessagesReceived = 0;
     std::chrono::steady_clock::time_point startTime;
@@ -0,0 +1,69 @@
+/**
+ * @file Session.hpp
+ * @brief Reference-counted handle on an authenticated client connection
+ */
+
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class Session
+ * @brief One authenticated connection of a user
+ * 
+ * Created by Server::registerClient and shared (std::shared_ptr) with every
+ * message addressed to it. Each registration gets a new generation number,
+ * so a handle kept by a queued message never refers to a later connection
+ * that reuses the same socket or username. Thread-safe, non-copyable.
+ */
+class Session {
+public:
+    /**
+     * @brief Constructor
+     * @param username Authenticated username
+     * @param socket Client socket
+     * @param generation Unique registration number
+     */
+    Session(std::string username, int socket, uint64_t generation);
+    
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+    
+    /**
+     * @brief Sends a raw frame if the session is still open
+     * @param message Data to send
+     * @return true if sent, false if closed or send failed
+     */
+    [[nodiscard]] bool send(const std::string& message);
+    
+    /**
+     * @brief Marks the session closed (waits for an in-flight send)
+     * 
+     * Must be called before the socket is closed, so that the fd can never
+     * be written through this session once the kernel reuses it.
+     */
+    void close();
+    
+    /**
+     * @brief Checks if the session is still registered
+     * @return true if open
+     */
+    bool isActive() const { return active.load(std::memory_order_acquire); }
+    
+    const std::string& getUsername() const { return username; }
+    int getSocket() const { return socket; }
+    uint64_t getGeneration() const { return generation; }
+
+private:
+    const std::string username;
+    const int socket;
+    const uint64_t generation;
+    std::atomic<bool> active{true};
+    std::mutex sendMutex;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file SessionRegistry.hpp
+ * @brief Connected clients indexed by username and socket, lock-free for readers
+ */
+
+#ifndef SESSION_REGISTRY_HPP
+#define SESSION_REGISTRY_HPP
+
+#include "Session.hpp"
+#include "Utils/FlatHashMap.hpp"
+#include "Utils/Rcu.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ClientInfo
+ * @brief Complete information of a connected client
+ *
+ * Shared by the registry snapshots; the heartbeat fields are atomics so the
+ * reader thread records inbound traffic without publishing a new snapshot.
+ */
+struct ClientInfo : std::enable_shared_from_this<ClientInfo> {
+    using Clock = std::chrono::steady_clock;
+
+    const int socket; //File descriptor
+    const std::shared_ptr<Session> session; //Handle shared with queued messages
+    std::atomic<Clock::rep> lastActivityTicks; //Last frame received (any frame counts as a PONG)
+    std::atomic<bool> waitingForPong{false}; //PING sent to an idle client, no answer yet
+
+    explicit ClientInfo(std::shared_ptr<Session> s)
+        : socket(s->getSocket()), session(std::move(s)), lastActivityTicks(Clock::now().time_since_epoch().count()) {}
+
+    Clock::time_point lastActivity() const {
+        return Clock::time_point(Clock::duration(lastActivityTicks.load(std::memory_order_relaxed)));
+    }
+
+    void touch(Clock::time_point when) {
+        lastActivityTicks.store(when.time_since_epoch().count(), std::memory_order_relaxed);
+        waitingForPong.store(false, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @class SessionRegistry
+ * @brief Username and socket indexes of the connected clients
+ *
+ * The username index is split in 1024 copy-on-write shards published through
+ * RCU, like the Banlist: lookups and snapshots take no lock, and a login or a
+ * logout copies one small shard under that shard's own mutex, so concurrent
+ * logins on different shards proceed in parallel. The socket index is a
+ * table of atomic pointers, allocated in chunks on first use and read under
+ * the same RCU guard.
+ */
+class SessionRegistry {
+public:
+    using Entry = std::shared_ptr<ClientInfo>;
+
+    SessionRegistry();
+    ~SessionRegistry();
+
+    SessionRegistry(const SessionRegistry&) = delete;
+    SessionRegistry& operator=(const SessionRegistry&) = delete;
+
+    /**
+     * @brief Registers a client, replacing any entry with the same name
+     * @param username Client name
+     * @param session Client session
+     * @return The new entry
+     */
+    Entry insert(const std::string& username, std::shared_ptr<Session> session);
+
+    /**
+     * @brief Registers a client unless the name is already registered
+     * @param username Client name
+     * @param session Client session
+     * @return The new entry (nullptr if the name is taken)
+     */
+    Entry tryInsert(const std::string& username, std::shared_ptr<Session> session);
+
+    /**
+     * @brief Unregisters a client
+     * @param username Client name
+     * @return The removed entry (nullptr if not found)
+     */
+    Entry remove(const std::string& username);
+
+    /**
+     * @brief Finds a client by name (lock-free)
+     */
+    Entry find(const std::string& username) const;
+
+    /**
+     * @brief Finds a client by socket (lock-free)
+     */
+    Entry findBySocket(int socket) const;
+
+    /**
+     * @brief Every connected client at one point in time (lock-free)
+     */
+    std::vector<Entry> snapshot() const;
+
+    /**
+     * @brief Number of connected clients
+     */
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Unregisters every client
+     */
+    void clear();
+
+private:
+    static constexpr size_t SHARDS = 1024;
+    static constexpr size_t SOCKET_CHUNK = 4096;
+    static constexpr size_t SOCKET_CHUNKS = 1024;  // Sockets up to 4M
+
+    using Map = Utils::FlatHashMap<std::string, Entry>;
+    using SocketChunk = std::array<std::atomic<ClientInfo*>, SOCKET_CHUNK>;
+
+    struct Shard {
+        explicit Shard(Utils::RcuDomain& domain) : map(domain) {}
+        Utils::RcuPtr<Map> map;
+        std::mutex writeMutex;
+    };
+
+    static size_t shardOf(const std::string& username);
+    Entry store(const std::string& username, std::shared_ptr<Session> session, bool replaceExisting);
+    std::atomic<ClientInfo*>* socketSlot(int socket, bool create);
+    const std::atomic<ClientInfo*>* socketSlot(int socket) const;
+    void unindexSocket(const ClientInfo& info);
+
+    mutable Utils::RcuDomain rcu;
+    std::array<std::unique_ptr<Shard>, SHARDS> shards;
+    std::array<std::atomic<SocketChunk*>, SOCKET_CHUNKS> socketChunks{};
+    std::mutex chunkMutex;
+    std::atomic<size_t> count{0};
+};
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * @file BinaryIO.hpp
+ * @brief Little helpers to encode and decode on-disk records
+ */
+
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Utils {
+
+inline void putU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void putU64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Appends a length-prefixed string
+ */
+inline void putString(std::string& out, const std::string& value) {
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+/**
+ * @class BinaryReader
+ * @brief Bounds-checked cursor over an encoded record (host byte order)
+ */
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t length) : data(data), left(length) {}
+
+    bool u8(uint8_t& value) { return raw(&value, sizeof(value)); }
+    bool u32(uint32_t& value) { return raw(&value, sizeof(value)); }
+    bool u64(uint64_t& value) { return raw(&value, sizeof(value)); }
+
+    bool str(std::string& value) {
+        uint32_t length;
+        if (!u32(length) || length > left) {
+            return false;
+        }
+        value.assign(data, length);
+        data += length;
+        left -= length;
+        return true;
+    }
+
+private:
+    bool raw(void* out, size_t size) {
+        if (size > left) {
+            return false;
+        }
+        std::memcpy(out, data, size);
+        data += size;
+        left -= size;
+        return true;
+    }
+
+    const char* data;
+    size_t left;
+};
+
+} // namespace Utils
+
+#endif
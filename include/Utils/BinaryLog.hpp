@@ -0,0 +1,245 @@
+/**
+ * @file BinaryLog.hpp
+ * @brief Binary log sink: fixed-size records in a memory-mapped ring file
+ */
+
+#ifndef BINARY_LOG_HPP
+#define BINARY_LOG_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * File layout (host byte order):
+ *  - one page of BinaryLogHeader;
+ *  - the format table: entries of a uint32 length and the pattern bytes, a
+ *    pattern's ID being 1 + its entry offset (ID 0: preformatted text);
+ *  - the ring of `capacity` BinaryLogRecord, record `sequence` in slot
+ *    `sequence % capacity`.
+ *
+ * Record payload: per argument a type tag, then an int64, uint64 or double
+ * (8 bytes), a bool or char (1 byte) or a string (uint16 length + bytes).
+ */
+struct BinaryLogHeader {
+    static constexpr char MAGIC[8] = {'C', 'H', 'A', 'T', 'B', 'L', 'O', 'G'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;           ///< Records in the ring
+    uint64_t formatsOffset;      ///< Of the format table in the file
+    uint64_t formatsSize;
+    int64_t realtimeAnchorNs;    ///< CLOCK_REALTIME ...
+    int64_t monotonicAnchorNs;   ///< ... at the same instant as this CLOCK_MONOTONIC
+    std::atomic<uint64_t> formatsUsed;   ///< Bytes reserved in the format table
+    std::atomic<uint64_t> nextSequence;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring file is shared between processes");
+
+struct BinaryLogRecord {
+    static constexpr size_t PAYLOAD_SIZE = 232;
+
+    std::atomic<uint64_t> commit;  ///< sequence + 1 once the record is complete
+    int64_t timeNs;                ///< CLOCK_MONOTONIC
+    uint32_t formatId;
+    uint8_t level;                 ///< LogLevel
+    uint8_t argCount;
+    uint16_t payloadSize;
+    unsigned char payload[PAYLOAD_SIZE];
+};
+static_assert(sizeof(BinaryLogRecord) == 256, "binary log records are 256 bytes");
+
+enum class BinaryArg : uint8_t { INT = 1, UINT, DOUBLE, BOOL, CHAR, STRING };
+
+/**
+ * @class BinaryLogWriter
+ * @brief Appends records from any thread without locking
+ *
+ * A slot is claimed with one fetch_add on the shared sequence and published
+ * by its commit field, so writers never wait for each other. The pages are
+ * the file's page cache: records survive a crash of the process without any
+ * flush. An existing file of the same geometry is continued (an upgraded
+ * process appends after its predecessor).
+ */
+class BinaryLogWriter {
+public:
+    /**
+     * @brief Argument types stored raw: numbers, bools, chars and strings
+     */
+    template<typename T>
+    static constexpr bool ENCODABLE = std::is_arithmetic_v<T> || std::is_convertible_v<const T&, std::string_view>;
+
+    BinaryLogWriter() = default;
+    ~BinaryLogWriter();
+
+    BinaryLogWriter(const BinaryLogWriter&) = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+    /**
+     * @brief Maps (creating or continuing) the ring file
+     * @return false if the file cannot be created or mapped
+     */
+    bool open(const std::string& path, uint64_t capacity);
+
+    /**
+     * @brief Adds a pattern to the file's format table
+     *
+     * Each call adds an entry: callers keep the ID (one per LOG_*F site).
+     * @return Its ID, 0 if the table is full
+     */
+    uint32_t registerFormat(std::string_view pattern);
+
+    /**
+     * @brief Appends a record of a registered pattern and its arguments
+     *
+     * Arguments that do not fit in the payload (232 bytes) are cut
+     * (strings, ending with "…") or dropped (decoded as "{}").
+     */
+    template<typename... Args>
+    void append(int level, uint32_t formatId, const Args&... args) {
+        uint64_t sequence;
+        BinaryLogRecord& record = claim(sequence);
+        record.formatId = formatId;
+        record.level = static_cast<uint8_t>(level);
+        size_t used = 0;
+        uint8_t count = 0;
+        (encode(record.payload, used, count, args), ...);
+        record.argCount = count;
+        record.payloadSize = static_cast<uint16_t>(used);
+        record.commit.store(sequence + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Appends an already formatted message (format ID 0)
+     *
+     * Beyond 229 bytes the text is cut and ends with "…".
+     */
+    void appendText(int level, std::string_view text) { append(level, 0, text); }
+
+private:
+    BinaryLogRecord& claim(uint64_t& sequence);
+
+    static void encodeRaw(unsigned char* payload, size_t& used, uint8_t& count, BinaryArg tag, const void* value, size_t size) {
+        if (used + 1 + size > BinaryLogRecord::PAYLOAD_SIZE) {
+            return;
+        }
+        payload[used] = static_cast<uint8_t>(tag);
+        std::memcpy(payload + used + 1, value, size);
+        used += 1 + size;
+        count++;
+    }
+
+    static void encodeString(unsigned char* payload, size_t& used, uint8_t& count, std::string_view text) {
+        static constexpr char ELLIPSIS[] = "\xE2\x80\xA6";  // UTF-8 "…"
+        constexpr size_t ELLIPSIS_SIZE = sizeof(ELLIPSIS) - 1;
+        if (used + 3 > BinaryLogRecord::PAYLOAD_SIZE) {
+            return;
+        }
+        size_t room = BinaryLogRecord::PAYLOAD_SIZE - used - 3;
+        size_t length = text.size();
+        bool cut = length > room;
+        if (cut) {
+            if (room < ELLIPSIS_SIZE) {
+                return;
+            }
+            // Cut on a character boundary, leaving room for the mark
+            length = room - ELLIPSIS_SIZE;
+            while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+                length--;
+            }
+        }
+        std::memcpy(payload + used + 3, text.data(), length);
+        if (cut) {
+            std::memcpy(payload + used + 3 + length, ELLIPSIS, ELLIPSIS_SIZE);
+            length += ELLIPSIS_SIZE;
+        }
+        uint16_t stored = static_cast<uint16_t>(length);
+        payload[used] = static_cast<uint8_t>(BinaryArg::STRING);
+        std::memcpy(payload + used + 1, &stored, sizeof(stored));
+        used += 3 + length;
+        count++;
+    }
+
+    template<typename T>
+    static void encode(unsigned char* payload, size_t& used, uint8_t& count, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            encodeRaw(payload, used, count, BinaryArg::BOOL, &value, 1);
+        } else if constexpr (std::is_same_v<T, char>) {
+            encodeRaw(payload, used, count, BinaryArg::CHAR, &value, 1);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            double number = value;
+            encodeRaw(payload, used, count, BinaryArg::DOUBLE, &number, sizeof(number));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            int64_t number = value;
+            encodeRaw(payload, used, count, BinaryArg::INT, &number, sizeof(number));
+        } else if constexpr (std::is_integral_v<T>) {
+            uint64_t number = value;
+            encodeRaw(payload, used, count, BinaryArg::UINT, &number, sizeof(number));
+        } else {
+            encodeString(payload, used, count, std::string_view(value));
+        }
+    }
+
+    int fd = -1;
+    unsigned char* base = nullptr;
+    size_t mappedSize = 0;
+    BinaryLogHeader* header = nullptr;
+    BinaryLogRecord* ring = nullptr;
+};
+
+/**
+ * @class BinaryLogReader
+ * @brief Decodes a ring file back to the text log layout
+ */
+class BinaryLogReader {
+public:
+    BinaryLogReader() = default;
+    ~BinaryLogReader();
+
+    BinaryLogReader(const BinaryLogReader&) = delete;
+    BinaryLogReader& operator=(const BinaryLogReader&) = delete;
+
+    /**
+     * @brief Maps the file read-only (it may still be written)
+     * @param error Set when false is returned
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Sequence numbers held by the ring: [first, end)
+     */
+    uint64_t firstSequence() const;
+    uint64_t endSequence() const;
+
+    /**
+     * @brief Decodes one record as "[YYYY-mm-dd HH:MM:SS.mmm] [LEVEL] message"
+     * @return false if the slot was overwritten or is not complete yet
+     */
+    bool line(uint64_t sequence, std::string& out) const;
+
+    /**
+     * @brief The last `count` lines of the ring, oldest first
+     */
+    std::vector<std::string> tail(size_t count) const;
+
+private:
+    std::string_view pattern(uint32_t formatId) const;
+
+    const unsigned char* base = nullptr;
+    size_t mappedSize = 0;
+    const BinaryLogHeader* header = nullptr;
+    const BinaryLogRecord* ring = nullptr;
+};
+
+} // namespace Utils
+
+#endif
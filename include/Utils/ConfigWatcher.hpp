@@ -0,0 +1,59 @@
+/**
+ * @file ConfigWatcher.hpp
+ * @brief Reloads the server config file into RuntimeConfig when it changes
+ */
+
+#ifndef CONFIG_WATCHER_HPP
+#define CONFIG_WATCHER_HPP
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace Utils {
+
+/**
+ * @class ConfigWatcher
+ * @brief One thread waiting on inotify for the config file to be rewritten
+ *
+ * The file's directory is watched rather than the file itself, so a file
+ * replaced by rename (what most editors and deployment tools do) is seen as
+ * well as one written in place. Events are let settle for
+ * CONFIG_RELOAD_DEBOUNCE_MS before the file is read, then it goes through
+ * RuntimeConfig::loadFile(): a rejected file is logged and the running
+ * values are kept.
+ */
+class ConfigWatcher {
+public:
+    /**
+     * @brief Starts watching
+     * @param path Config file (already loaded once by the caller)
+     * @param onThreadStart Called first on the watcher thread
+     */
+    explicit ConfigWatcher(const std::string& path, std::function<void()> onThreadStart = {});
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    /**
+     * @brief Whether the inotify watch and the thread could be created
+     */
+    bool isOpen() const { return open; }
+
+private:
+    void run();
+    bool waitForChange();
+    void reload();
+
+    std::string path;
+    std::string fileName;  ///< Entry of path in the watched directory
+    int inotifyFd = -1;
+    int stopFd = -1;       ///< eventfd: readable once the watcher must stop
+    bool open = false;
+    std::thread thread;
+};
+
+} // namespace Utils
+
+#endif
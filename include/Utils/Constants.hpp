@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <chrono>
 #include <string>
+#include <cstdint>
 
 /**
  * @namespace Constants
@@ -17,18 +18,31 @@
 namespace Constants {
     constexpr size_t BUFFER_SIZE = 4096;                ///< Network buffer size
     constexpr size_t MAX_MESSAGE_SIZE = 10 * 1024 * 1024; ///< Max message size (10MB)
-    constexpr size_t MAX_QUEUE_SIZE = 1000;              ///< Max dispatcher queue size
+    constexpr size_t MAX_QUEUE_SIZE = 10000;             ///< Max dispatcher queue size (messages)
+    constexpr int MAX_QUEUE_KB = 256 * 1024;             ///< Max dispatcher queue memory (KB)
+    constexpr int MAX_QUEUE_KB_PER_USER = 32 * 1024;     ///< Max queued memory per recipient (KB)
     
     constexpr int HEARTBEAT_INTERVAL_S = 30;            ///< Heartbeat interval (s)
     constexpr int HEARTBEAT_CHECK_DELAY_S = 5;          ///< Delay after PING before checking (s)
     constexpr int HEARTBEAT_TIMEOUT_S = 90;             ///< Timeout before client timeout (s)
+    constexpr int HEARTBEAT_TICK_MS = 100;              ///< Heartbeat timer wheel resolution (ms)
     constexpr int CLIENT_TIMEOUT_S = 120;                ///< Client inactivity timeout (s)
     constexpr int DISPATCHER_SLEEP_MS = 1;               ///< Dispatcher sleep (ms)
     constexpr int MAIN_LOOP_SLEEP_S = 1;                 ///< Main loop sleep (s)
+    constexpr int TIMER_WHEEL_TICK_MS = 10;              ///< Dispatcher timer wheel resolution (ms)
+    constexpr int MAX_MESSAGE_TTL_S = 7 * 24 * 3600;     ///< Max SEND ttl= option (s)
+    constexpr int MAX_SCHEDULE_DELAY_S = 30 * 24 * 3600; ///< Max SEND delay=/at= option (s)
     
     constexpr bool AUTO_STOP_WHEN_NO_CLIENTS = false;    ///< Auto stop server when no clients
     
-    constexpr size_t THREAD_POOL_SIZE = 12;              ///< ThreadPool workers count
+    constexpr size_t THREAD_POOL_SIZE = 12;              ///< Pool workers when hardware_concurrency() is unknown
+    constexpr int THREAD_POOL_MAX = 64;                  ///< Autoscale upper bound
+    constexpr int THREAD_POOL_TARGET_WAIT_MS = 5;        ///< Autoscale grows the pool above this queue wait (ms)
+    constexpr int POOL_MONITOR_INTERVAL_MS = 500;        ///< Pool resize and autoscale period (ms)
+    constexpr int CONFIG_RELOAD_DEBOUNCE_MS = 200;       ///< Quiet time after a config file change before it is read (ms)
+    constexpr int EVENT_LOOP_MAX_EVENTS = 256;           ///< Events returned by one epoll_wait
+    constexpr size_t EVENT_LOOP_READ_BUDGET = 64 * 1024; ///< Bytes read from one socket per task
+    constexpr size_t IO_LOOP_THREADS = 2;                ///< epoll threads resuming connection coroutines
     
     constexpr int DEFAULT_PORT = 8080;                   ///< Default port
     constexpr int MAX_PENDING_CONNECTIONS = 10;          ///< Max pending connections
@@ -49,7 +63,33 @@ namespace Constants {
     
     const std::string DEFAULT_SERVER_LOG = "server.log"; ///< Server log file
     const std::string DEFAULT_CLIENT_LOG = "client.log"; ///< Client log file
+    constexpr size_t ASYNC_LOG_RING_SLOTS = 512;         ///< 128-byte records per thread ring (async logging)
+    constexpr int ASYNC_LOG_FLUSH_MS = 20;               ///< Max delay before an async record is written (ms)
+    constexpr size_t ASYNC_LOG_MAX_RINGS = 1024;         ///< Threads logging at once in async mode (more log synchronously)
+    constexpr int LOG_ROTATE_SIZE_KB = 10 * 1024;        ///< Log segment size before rotation (0: no limit)
+    constexpr int LOG_ROTATE_AGE_MIN = 24 * 60;          ///< Log segment age before rotation (0: no limit)
+    constexpr int LOG_ROTATE_KEEP = 5;                   ///< Rotated log segments kept
+    constexpr size_t LOG_PAGE_LINES = 50;                ///< Lines per GET_LOG page
+    const std::string DEFAULT_BINARY_LOG = "server.binlog"; ///< Binary log ring file (--binary-log)
+    constexpr uint64_t BINARY_LOG_RECORDS = 65536;       ///< 256-byte records kept by the binary log ring
     const std::string DEFAULT_BANLIST = "banlist";       ///< Banned clients file
+    constexpr size_t BANLIST_COMPACT_MIN_ENTRIES = 1024; ///< Journal size before a banlist compaction
+    const std::string DEFAULT_OFFLINE_DIR = "offline";   ///< Offline mailbox segments directory
+    constexpr uint64_t OFFLINE_SEGMENT_SIZE = 64 * 1024 * 1024; ///< Offline segment roll size (bytes)
+    constexpr int OFFLINE_MAX_KB_PER_USER = 4 * 1024;    ///< Max stored mail per offline recipient (KB)
+    constexpr int OFFLINE_MAX_MB = 1024;                 ///< Max stored mail in total (MB)
+    constexpr int OFFLINE_TTL_H = 7 * 24;                ///< Stored messages without ttl= expire after this (h, 0: never)
+    constexpr int OFFLINE_EXPIRY_SWEEP_S = 60;           ///< Period of the expired mail sweep (s)
+    const std::string DEFAULT_HISTORY_DIR = "history";   ///< Per-user history directory
+    constexpr uint64_t HISTORY_SEGMENT_SIZE = 16 * 1024 * 1024; ///< History segment roll size (bytes)
+    constexpr int HISTORY_PAGE_SIZE = 20;                ///< Default HISTORY page size
+    constexpr int HISTORY_PAGE_MAX = 200;                ///< Max HISTORY page size
+    constexpr int GROUP_COMMIT_DELAY_MS = 2;             ///< Max wait to grow an fsync batch (ms)
+    constexpr size_t GROUP_COMMIT_MAX_BYTES = 1024 * 1024; ///< Batch size that triggers an fsync early (bytes)
+    const std::string DEFAULT_HANDOFF_SOCKET = "handoff.sock"; ///< Unix socket used by /upgrade
+    constexpr int HANDOFF_TIMEOUT_MS = 10000;            ///< Max wait for the new process at each upgrade step (ms)
+    constexpr int HANDOFF_PARK_TIMEOUT_MS = 50;          ///< Max wait for readers to stop between frames (ms)
+    constexpr size_t HANDOFF_BATCH_FDS = 250;            ///< Sockets per SCM_RIGHTS message (kernel max 253)
     
     constexpr size_t LENGTH_PREFIX_SIZE = 4;             ///< Length prefix size (bytes)
 }
@@ -0,0 +1,126 @@
+/**
+ * @file Coroutine.hpp
+ * @brief C++20 coroutine types for connection handlers (ENABLE_COROUTINES builds)
+ */
+
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#ifdef ENABLE_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace Utils {
+
+/**
+ * @class Coroutine
+ * @brief Lazily started coroutine returning a T to the coroutine awaiting it
+ *
+ * Nothing runs until it is co_awaited; when it finishes, the awaiting
+ * coroutine resumes on the same thread (symmetric transfer, so long chains of
+ * frames do not grow the stack). Exceptions are rethrown to the awaiter.
+ * Owned by the awaiting frame: there is no way to run one detached.
+ */
+template<typename T>
+class [[nodiscard]] Coroutine {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        Coroutine get_return_object() noexcept {
+            return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> done) noexcept {
+                return done.promise().continuation;
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    Coroutine(Coroutine&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+    Coroutine& operator=(Coroutine&&) = delete;
+
+    ~Coroutine() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit Coroutine(std::coroutine_handle<promise_type> coroutine) : handle(coroutine) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @struct Detached
+ * @brief Return type of a coroutine that starts at once and frees itself
+ *
+ * For top-level coroutines such as one connection's handler: the caller
+ * gets control back at the first suspension and nobody waits for the end.
+ * An escaping exception terminates, as it would in a std::thread.
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Awaitable that resumes the coroutine as a task of the given pool
+ *
+ * `co_await resumeOn(pool)` moves the rest of the coroutine (until its next
+ * suspension) off the calling thread, for work that may block.
+ */
+template<typename Pool>
+auto resumeOn(Pool& pool) {
+    struct Awaiter {
+        Pool& pool;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            pool.enqueue([coroutine] { coroutine.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{pool};
+}
+
+} // namespace Utils
+
+#endif // ENABLE_COROUTINES
+
+#endif
@@ -0,0 +1,310 @@
+/**
+ * @file FlatHashMap.hpp
+ * @brief Open-addressing hash map and set with stored hashes
+ */
+
+#ifndef FLAT_HASH_MAP_HPP
+#define FLAT_HASH_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+
+namespace detail {
+
+/**
+ * @class FlatTable
+ * @brief Linear-probing table shared by FlatHashMap and FlatHashSet
+ *
+ * Elements live in one contiguous array; a parallel array keeps the full hash
+ * of every slot (0 = empty), so a probe compares 8-byte hashes in sequence and
+ * touches a key only when the hashes match. Keys are stored by value: a
+ * std::string key of up to 15 characters (SSO) sits inline in its slot with
+ * no extra allocation. Erasure shifts the following run back instead of
+ * leaving tombstones. Capacity is a power of two, load factor at most 3/4.
+ * Iterators and element addresses are invalidated by any insertion or erasure.
+ *
+ * @tparam Key Key type
+ * @tparam Element Stored element (the key, or a key/value pair)
+ * @tparam KeyOf Extracts the key from an element
+ * @tparam Hash Hash function of Key
+ */
+template<typename Key, typename Element, typename KeyOf, typename Hash>
+class FlatTable {
+public:
+    template<bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Element;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Element*, Element*>;
+        using reference = std::conditional_t<Const, const Element&, Element&>;
+        using Table = std::conditional_t<Const, const FlatTable, FlatTable>;
+
+        Iterator() = default;
+        Iterator(Table* table, size_t index) : table(table), index(index) { skipEmpty(); }
+        operator Iterator<true>() const { return Iterator<true>(table, index); }
+
+        reference operator*() const { return table->elements[index]; }
+        pointer operator->() const { return &table->elements[index]; }
+
+        Iterator& operator++() {
+            ++index;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+    private:
+        friend class FlatTable;
+
+        void skipEmpty() {
+            while (index < table->hashes.size() && table->hashes[index] == EMPTY) {
+                ++index;
+            }
+        }
+
+        Table* table = nullptr;
+        size_t index = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, hashes.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, hashes.size()); }
+
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+    size_t capacity() const { return hashes.size(); }
+
+    iterator find(const Key& key) {
+        return iterator(this, findIndex(key));
+    }
+
+    const_iterator find(const Key& key) const {
+        return const_iterator(this, findIndex(key));
+    }
+
+    size_t count(const Key& key) const { return findIndex(key) != hashes.size() ? 1 : 0; }
+    bool contains(const Key& key) const { return findIndex(key) != hashes.size(); }
+
+    /**
+     * @brief Removes the element with this key
+     * @return Number of removed elements (0 or 1)
+     */
+    size_t erase(const Key& key) {
+        size_t index = findIndex(key);
+        if (index == hashes.size()) {
+            return 0;
+        }
+        eraseAt(index);
+        return 1;
+    }
+
+    void erase(iterator position) {
+        eraseAt(position.index);
+    }
+
+    void clear() {
+        hashes.clear();
+        elements.clear();
+        used = 0;
+    }
+
+    /**
+     * @brief Grows the table so @p n elements fit without rehashing
+     */
+    void reserve(size_t n) {
+        size_t wanted = MIN_CAPACITY;
+        while (wanted * 3 / 4 < n) {
+            wanted *= 2;
+        }
+        if (wanted > hashes.size()) {
+            rehash(wanted);
+        }
+    }
+
+    /**
+     * @brief Approximate heap bytes held by the table (slots only)
+     */
+    size_t memoryUsage() const {
+        return hashes.capacity() * sizeof(size_t) + elements.capacity() * sizeof(Element);
+    }
+
+protected:
+    static constexpr size_t EMPTY = 0;
+    static constexpr size_t MIN_CAPACITY = 8;
+
+    static size_t hashOf(const Key& key) {
+        size_t hash = Hash{}(key);
+        return hash == EMPTY ? 1 : hash;
+    }
+
+    size_t findIndex(const Key& key) const {
+        if (used == 0) {
+            return hashes.size();
+        }
+        size_t hash = hashOf(key);
+        size_t mask = hashes.size() - 1;
+        for (size_t index = hash & mask;; index = (index + 1) & mask) {
+            if (hashes[index] == EMPTY) {
+                return hashes.size();
+            }
+            if (hashes[index] == hash && KeyOf{}(elements[index]) == key) {
+                return index;
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the slot of @p key, or claims an empty one for it
+     * @return Slot index and whether it was claimed
+     */
+    std::pair<size_t, bool> findOrClaim(const Key& key) {
+        if ((used + 1) * 4 > hashes.size() * 3) {
+            rehash(hashes.empty() ? MIN_CAPACITY : hashes.size() * 2);
+        }
+        size_t hash = hashOf(key);
+        size_t mask = hashes.size() - 1;
+        for (size_t index = hash & mask;; index = (index + 1) & mask) {
+            if (hashes[index] == EMPTY) {
+                hashes[index] = hash;
+                ++used;
+                return {index, true};
+            }
+            if (hashes[index] == hash && KeyOf{}(elements[index]) == key) {
+                return {index, false};
+            }
+        }
+    }
+
+    void eraseAt(size_t index) {
+        size_t mask = hashes.size() - 1;
+        size_t hole = index;
+
+        // Backward shift: pull later members of the run into the hole as long
+        // as that does not move them before their home slot
+        for (size_t next = (hole + 1) & mask; hashes[next] != EMPTY; next = (next + 1) & mask) {
+            size_t home = hashes[next] & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                hashes[hole] = hashes[next];
+                elements[hole] = std::move(elements[next]);
+                hole = next;
+            }
+        }
+        hashes[hole] = EMPTY;
+        elements[hole] = Element();
+        --used;
+    }
+
+    void rehash(size_t newCapacity) {
+        std::vector<size_t> oldHashes(newCapacity, EMPTY);
+        std::vector<Element> oldElements(newCapacity);
+        oldHashes.swap(hashes);
+        oldElements.swap(elements);
+
+        size_t mask = newCapacity - 1;
+        for (size_t i = 0; i < oldHashes.size(); ++i) {
+            if (oldHashes[i] == EMPTY) {
+                continue;
+            }
+            size_t index = oldHashes[i] & mask;
+            while (hashes[index] != EMPTY) {
+                index = (index + 1) & mask;
+            }
+            hashes[index] = oldHashes[i];
+            elements[index] = std::move(oldElements[i]);
+        }
+    }
+
+    std::vector<size_t> hashes;
+    std::vector<Element> elements;
+    size_t used = 0;
+};
+
+template<typename Key, typename Value>
+struct SelectFirst {
+    const Key& operator()(const std::pair<Key, Value>& element) const { return element.first; }
+};
+
+template<typename Key>
+struct Identity {
+    const Key& operator()(const Key& element) const { return element; }
+};
+
+} // namespace detail
+
+/**
+ * @class FlatHashMap
+ * @brief Cache-friendly replacement for std::unordered_map on hot lookup paths
+ *
+ * Elements are std::pair<Key, Value> (structured bindings work as with the
+ * std containers). Key and Value must be default-constructible and movable.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap : public detail::FlatTable<Key, std::pair<Key, Value>, detail::SelectFirst<Key, Value>, Hash> {
+    using Base = detail::FlatTable<Key, std::pair<Key, Value>, detail::SelectFirst<Key, Value>, Hash>;
+
+public:
+    using value_type = std::pair<Key, Value>;
+
+    /**
+     * @brief Inserts a value built from @p args unless the key exists
+     * @return Iterator to the element and whether it was inserted
+     */
+    template<typename... Args>
+    std::pair<typename Base::iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto [index, claimed] = this->findOrClaim(key);
+        if (claimed) {
+            this->elements[index] = value_type(key, Value(std::forward<Args>(args)...));
+        }
+        return {typename Base::iterator(this, index), claimed};
+    }
+
+    std::pair<typename Base::iterator, bool> emplace(const Key& key, Value value) {
+        return try_emplace(key, std::move(value));
+    }
+
+    Value& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+};
+
+/**
+ * @class FlatHashSet
+ * @brief Cache-friendly replacement for std::unordered_set on hot lookup paths
+ */
+template<typename Key, typename Hash = std::hash<Key>>
+class FlatHashSet : public detail::FlatTable<Key, Key, detail::Identity<Key>, Hash> {
+    using Base = detail::FlatTable<Key, Key, detail::Identity<Key>, Hash>;
+
+public:
+    using value_type = Key;
+
+    /**
+     * @brief Inserts a key
+     * @return Iterator to the element and whether it was inserted
+     */
+    std::pair<typename Base::const_iterator, bool> insert(const Key& key) {
+        auto [index, claimed] = this->findOrClaim(key);
+        if (claimed) {
+            this->elements[index] = key;
+        }
+        return {typename Base::const_iterator(this, index), claimed};
+    }
+};
+
+} // namespace Utils
+
+#endif
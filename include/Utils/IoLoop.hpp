@@ -0,0 +1,133 @@
+/**
+ * @file IoLoop.hpp
+ * @brief epoll threads resuming coroutines that wait for a socket (ENABLE_COROUTINES builds)
+ */
+
+#ifndef IO_LOOP_HPP
+#define IO_LOOP_HPP
+
+#ifdef ENABLE_COROUTINES
+
+#include "Utils/Coroutine.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+namespace Utils {
+
+/**
+ * @class IoLoop
+ * @brief A few epoll threads on which suspended socket readers resume
+ *
+ * A coroutine that `co_await loop.readable(socket)` is registered one-shot on
+ * the epoll instance of thread `socket % size()` and resumed on that thread
+ * once the socket is readable (or hung up). Waiting costs the coroutine frame
+ * only, so tens of thousands of idle connections need no thread each.
+ *
+ * Closing a socket removes it from epoll: its owner must not close it while
+ * waiting on it. Use shutdown() from other threads, which wakes the waiter.
+ * Coroutines still waiting when the loop is destroyed are never resumed.
+ */
+class IoLoop {
+public:
+    /**
+     * @brief Starts the loop threads
+     * @param threads Number of epoll threads (at least one)
+     * @param onThreadStart Called first on each thread, with its index
+     */
+    explicit IoLoop(size_t threads, std::function<void(size_t)> onThreadStart = {});
+    ~IoLoop();
+
+    IoLoop(const IoLoop&) = delete;
+    IoLoop& operator=(const IoLoop&) = delete;
+
+    /**
+     * @brief Whether every epoll instance and thread could be created
+     */
+    bool isOpen() const { return open; }
+
+    size_t size() const { return epollFds.size(); }
+
+    /**
+     * @class ReadableAwaiter
+     * @brief Result of readable(): resumes with false if the socket cannot be watched
+     */
+    class ReadableAwaiter {
+    public:
+        ReadableAwaiter(IoLoop& loop, int socket) : loop(loop), socket(socket) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) {
+            // Once watched, a loop thread may resume (and free) this frame at any time
+            if (!loop.watch(socket, coroutine)) {
+                failed = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool await_resume() const noexcept { return !failed; }
+
+    private:
+        IoLoop& loop;
+        int socket;
+        bool failed = false;
+    };
+
+    /**
+     * @brief Suspends the calling coroutine until the socket is readable
+     */
+    ReadableAwaiter readable(int socket) { return ReadableAwaiter(*this, socket); }
+
+private:
+    bool watch(int socket, std::coroutine_handle<> coroutine);
+    void run(size_t index);
+
+    std::vector<int> epollFds;
+    std::vector<std::thread> threads;
+    int stopFd = -1;
+    bool open = false;
+};
+
+/**
+ * @class AsyncStream
+ * @brief NetworkStream::receive() for coroutines
+ *
+ * Same framing and limits as NetworkStream; the socket stays in blocking
+ * mode for the send paths and reads use MSG_DONTWAIT, suspending on the
+ * IoLoop when nothing is buffered. Bytes of an incomplete frame are kept
+ * here and released as soon as the frame completes.
+ */
+class AsyncStream {
+public:
+    AsyncStream(IoLoop& loop, int socket) : loop(loop), socketFd(socket), connected(socket >= 0) {}
+
+    /**
+     * @brief Next frame, or nullopt once the peer closed or sent a malformed frame
+     */
+    Coroutine<std::optional<std::string>> receive();
+
+    bool isConnected() const { return connected; }
+
+private:
+    std::optional<std::string> takeFrame();
+    ssize_t fill();  ///< One recv() into pending; keeps the chunk out of the coroutine frame
+
+    IoLoop& loop;
+    int socketFd;
+    bool connected;
+    std::string pending;
+    size_t offset = 0;  ///< Start of the first frame not yet returned
+};
+
+} // namespace Utils
+
+#endif // ENABLE_COROUTINES
+
+#endif
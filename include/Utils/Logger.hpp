@@ -7,7 +7,31 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "BinaryLog.hpp"
 #include "Colors.hpp"
+#include "Constants.hpp"
+#include <array>
+
+/**
+ * Compile-time floor: sites below this level (0 DEBUG, 1 INFO, 2 WARNING,
+ * 3 ERROR) are compiled out, arguments included. Release builds (NDEBUG)
+ * drop DEBUG.
+ */
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
 
 enum class LogLevel {
     DEBUG,
@@ -18,6 +42,26 @@ enum class LogLevel {
     DISCONNECT
 };
 
+struct LogRing;
+
+/**
+ * @class Logger
+ * @brief Process-wide log to a file and the console
+ *
+ * Synchronous by default: each record is written (and reaches the file)
+ * before log() returns. In async mode (setAsync), log() only copies the
+ * record into a ring owned by the calling thread, without locking; a writer
+ * thread drains every ring, formats the records in timestamp order and
+ * writes them in batches (at least every ASYNC_LOG_FLUSH_MS). What is still
+ * in the rings is written on flush(), on exit and on a fatal signal. The ring
+ * of an exited thread is reused by the next new thread once drained, never
+ * freed, so the signal handler can walk the rings without a lock.
+ *
+ * With a binary log (setBinaryLog), records go to a memory-mapped ring file
+ * instead of the text file: the LOG_*F macros store their pattern once and
+ * only the raw arguments per record, without formatting nor timestamp
+ * rendering. bin/logdump prints the file in the text layout.
+ */
 class Logger {
 public:
     static Logger& getInstance() {
@@ -26,35 +70,256 @@ public:
     }
 
     void setLogFile(const std::string& filename);
+
+    /**
+     * @brief Rotates the text log file: it is renamed <file>.<segment> and reopened
+     *
+     * A segment is closed before a record would take it past maxBytes, or once
+     * it is older than maxAge (0: no limit). Only the `keep` newest closed
+     * segments are kept.
+     */
+    void setRotation(uint64_t maxBytes, std::chrono::seconds maxAge, size_t keep);
+
+    /**
+     * @brief Number of the segment being written, the suffix it gets when rotated
+     *
+     * Segment numbers only grow, so they stay valid across rotations.
+     */
+    uint64_t getLogSegment() const { return segment.load(std::memory_order_acquire); }
+
+    /**
+     * @brief File of a segment: the log file itself for the current one
+     */
+    std::string getSegmentPath(uint64_t number);
+
+    /**
+     * @brief Writes records to a binary ring file instead of the text file
+     *
+     * Called once, before any logging thread starts. The console output is
+     * unchanged.
+     * @return false if the file cannot be mapped
+     */
+    bool setBinaryLog(const std::string& filename);
+
+    /**
+     * @brief Path of the binary log, empty if records go to the text file
+     */
+    const std::string& getBinaryLogPath() const { return binaryLogPath; }
+
+    /**
+     * @brief Format-table ID of one LOG_*F call site, registered on first use
+     */
+    struct FormatSite {
+        static constexpr uint32_t TEXT = UINT32_MAX;  ///< Table full: recorded as formatted text
+        std::atomic<uint32_t> id{0};
+    };
+
+    /**
+     * @brief log(level, format(pattern, args...)), without formatting for the binary log
+     */
+    template<typename... Args>
+    void logFormat(FormatSite& site, LogLevel level, std::string_view pattern, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        if (!binaryLog) {
+            write(level, format(pattern, args...));
+            return;
+        }
+        uint32_t id = 0;
+        if constexpr ((Utils::BinaryLogWriter::ENCODABLE<Args> && ...)) {
+            id = formatId(site, pattern);
+        }
+        if (id != 0) {
+            binaryLog->append(static_cast<int>(level), id, args...);
+        } else {
+            binaryLog->appendText(static_cast<int>(level), format(pattern, args...));
+        }
+        if (showsOnConsole(level)) {
+            write(level, format(pattern, args...));
+        }
+    }
+
+    /**
+     * @brief Mirrors DEBUG records to the console, lowering the minimum level to DEBUG
+     */
     void setVerbose(bool enabled);
+    bool isVerbose() const { return verbose; }
     void log(LogLevel level, const std::string& message);
 
+    /**
+     * @brief Runtime minimum level: records below it are not built nor written
+     *
+     * CONNECT and DISCONNECT count as INFO. Default INFO (DEBUG with -v).
+     */
+    void setMinimumLevel(LogLevel level) { minimumSeverity.store(severity(level), std::memory_order_relaxed); }
+    LogLevel getMinimumLevel() const { return static_cast<LogLevel>(minimumSeverity.load(std::memory_order_relaxed)); }
+
+    /**
+     * @brief Checked by the LOG_* macros before evaluating their arguments
+     */
+    static bool isEnabled(LogLevel level) {
+        return severity(level) >= minimumSeverity.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Parses a minimum level name (debug, info, warning, error)
+     * @return false if the name is unknown
+     */
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static const char* levelName(LogLevel level);
+
+    static constexpr int severity(LogLevel level) {
+        return level == LogLevel::CONNECT || level == LogLevel::DISCONNECT ? static_cast<int>(LogLevel::INFO)
+                                                                           : static_cast<int>(level);
+    }
+
+    /**
+     * @brief Replaces each "{}" of the pattern with the next argument
+     *
+     * Strings are appended as they are, numbers with std::to_string, bools as
+     * true/false; extra arguments are ignored, extra "{}" are kept.
+     */
+    template<typename... Args>
+    static std::string format(std::string_view pattern, const Args&... args) {
+        std::string out;
+        out.reserve(pattern.size() + 16 * sizeof...(Args));
+        size_t position = 0;
+        auto next = [&](const auto& arg) {
+            size_t brace = pattern.find("{}", position);
+            if (brace == std::string_view::npos) {
+                return;
+            }
+            out.append(pattern, position, brace - position);
+            appendArgument(out, arg);
+            position = brace + 2;
+        };
+        (next(args), ...);
+        out.append(pattern, position, std::string_view::npos);
+        return out;
+    }
+
+    /**
+     * @brief Switches between synchronous and asynchronous writing
+     *
+     * Enabling also installs the fatal signal handlers that write out the
+     * pending records; disabling drains the rings first.
+     */
+    void setAsync(bool enabled);
+    bool isAsync() const { return async.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Writes every pending record before returning (async mode)
+     */
+    void flush();
+
 private:
     Logger() = default;
-    ~Logger() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
-    }
+    ~Logger();
 
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    template<typename T>
+    static void appendArgument(std::string& out, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, char>) {
+            out += value;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            out += std::to_string(value);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            out += std::string_view(value);
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            out += stream.str();
+        }
+    }
+
     std::string levelToString(LogLevel level);
     std::string getColorForLevel(LogLevel level);
     std::string getCurrentTimestamp();
 
-    std::ofstream logFile;
+    /**
+     * @brief Writes an enabled record to the text file (if any) and the console
+     */
+    void write(LogLevel level, const std::string& message);
+    void writeFile(const std::string& data);  ///< With logMutex held
+    void rotate();                            ///< With logMutex held
+    bool showsOnConsole(LogLevel level) const { return level != LogLevel::DEBUG || verbose; }
+    uint32_t formatId(FormatSite& site, std::string_view pattern);
+
+    // Async mode
+    LogRing* threadRing();  ///< nullptr: log synchronously
+    void writerLoop();
+    void drain();
+    void emergencyDrain();  ///< From a fatal signal: no locks, no allocation
+    static void onFatalSignal(int signal);
+
+    int logFd = -1;  ///< Appended with write(2), usable from a signal handler
     std::mutex logMutex;
-    bool verbose = false;
+    std::string logPath;
+
+    // Rotation, guarded by logMutex
+    uint64_t fileBytes = 0;
+    std::chrono::system_clock::time_point segmentStart;
+    uint64_t rotateBytes = 0;
+    std::chrono::seconds rotateAge{0};
+    size_t rotateKeep = 0;
+    std::atomic<uint64_t> segment{1};
+    std::atomic<bool> verbose{false};
+    std::unique_ptr<Utils::BinaryLogWriter> binaryLog;  ///< Set once, before logging starts
+    std::string binaryLogPath;
+
+    static inline std::atomic<int> minimumSeverity{static_cast<int>(LogLevel::INFO)};
+
+    std::atomic<bool> async{false};
+    std::mutex ringsMutex;  ///< Serializes ring creation and reuse
+    std::array<std::atomic<LogRing*>, Constants::ASYNC_LOG_MAX_RINGS> rings{};  ///< Append-only
+    std::atomic<size_t> ringCount{0};
+    int64_t utcOffsetS = 0;  ///< Local time offset for the signal handler, set when async mode starts
+    std::mutex drainMutex;  ///< One drain at a time (writer, flush)
+    std::mutex writerMutex;
+    std::condition_variable writerCv;
+    bool writerRunning = false;
+    std::thread writer;
 };
 
-// Macros pour simplifier l'utilisation
-#define LOG_DEBUG(msg) Logger::getInstance().log(LogLevel::DEBUG, msg)
-#define LOG_INFO(msg) Logger::getInstance().log(LogLevel::INFO, msg)
-#define LOG_WARNING(msg) Logger::getInstance().log(LogLevel::WARNING, msg)
-#define LOG_ERROR(msg) Logger::getInstance().log(LogLevel::ERROR, msg)
-#define LOG_CONNECT(msg) Logger::getInstance().log(LogLevel::CONNECT, msg)
-#define LOG_DISCONNECT(msg) Logger::getInstance().log(LogLevel::DISCONNECT, msg)
+// Macros pour simplifier l'utilisation : le niveau (constant) est testé avant d'évaluer le message
+#define LOG_AT(level, msg) \
+    do { \
+        if constexpr (Logger::severity(level) >= LOG_COMPILE_LEVEL) { \
+            if (Logger::isEnabled(level)) { \
+                Logger::getInstance().log(level, msg); \
+            } \
+        } \
+    } while (0)
+
+// Variantes à formatage paresseux : LOG_DEBUGF("Message from {} to {}", from, to)
+// Avec le journal binaire, le motif est enregistré une fois par site et seuls les arguments sont écrits
+#define LOG_ATF(level, ...) \
+    do { \
+        if constexpr (Logger::severity(level) >= LOG_COMPILE_LEVEL) { \
+            if (Logger::isEnabled(level)) { \
+                static Logger::FormatSite logSite; \
+                Logger::getInstance().logFormat(logSite, level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(msg) LOG_AT(LogLevel::DEBUG, msg)
+#define LOG_INFO(msg) LOG_AT(LogLevel::INFO, msg)
+#define LOG_WARNING(msg) LOG_AT(LogLevel::WARNING, msg)
+#define LOG_ERROR(msg) LOG_AT(LogLevel::ERROR, msg)
+#define LOG_CONNECT(msg) LOG_AT(LogLevel::CONNECT, msg)
+#define LOG_DISCONNECT(msg) LOG_AT(LogLevel::DISCONNECT, msg)
+
+#define LOG_DEBUGF(...) LOG_ATF(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFOF(...) LOG_ATF(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNINGF(...) LOG_ATF(LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERRORF(...) LOG_ATF(LogLevel::ERROR, __VA_ARGS__)
+#define LOG_CONNECTF(...) LOG_ATF(LogLevel::CONNECT, __VA_ARGS__)
+#define LOG_DISCONNECTF(...) LOG_ATF(LogLevel::DISCONNECT, __VA_ARGS__)
 
 #endif // LOGGER_HPP
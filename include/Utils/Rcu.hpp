@@ -0,0 +1,145 @@
+/**
+ * @file Rcu.hpp
+ * @brief Read-copy-update: wait-free readers, copy-on-write writers
+ */
+
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Utils {
+
+/**
+ * @class RcuDomain
+ * @brief Tracks read-side critical sections so writers can wait for them
+ *
+ * A reader bumps one of a few cache-line padded counters, picked by thread,
+ * under the current epoch parity. synchronize() flips the parity twice and
+ * waits for the counters of the previous parity to drain, so every reader
+ * that could still hold an old pointer has left. Readers never block; writers
+ * (rare) pay the wait.
+ */
+class RcuDomain {
+public:
+    /**
+     * @class ReadGuard
+     * @brief RAII read-side critical section
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(RcuDomain& domain) : domain(domain), slot(threadSlot()) {
+            parity = domain.epoch.load(std::memory_order_seq_cst) & 1;
+            domain.counters[parity][slot].value.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        ~ReadGuard() {
+            domain.counters[parity][slot].value.fetch_sub(1, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        RcuDomain& domain;
+        size_t slot;
+        size_t parity;
+    };
+
+    RcuDomain() = default;
+    RcuDomain(const RcuDomain&) = delete;
+    RcuDomain& operator=(const RcuDomain&) = delete;
+
+    /**
+     * @brief Waits until every read-side section started before the call has ended
+     */
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(syncMutex);
+        for (int phase = 0; phase < 2; ++phase) {
+            size_t parity = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+            for (auto& counter : counters[parity]) {
+                while (counter.value.load(std::memory_order_acquire) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t SLOTS = 32;
+
+    struct alignas(64) Counter {
+        std::atomic<int64_t> value{0};
+    };
+
+    static size_t threadSlot() {
+        static thread_local const size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % SLOTS;
+        return slot;
+    }
+
+    std::atomic<uint64_t> epoch{0};
+    std::array<std::array<Counter, SLOTS>, 2> counters;
+    std::mutex syncMutex;
+};
+
+/**
+ * @class RcuPtr
+ * @brief Pointer to an immutable snapshot, replaced as a whole by writers
+ *
+ * Readers call get() inside a ReadGuard of the same domain. Writers build a
+ * new snapshot and publish it with replace(), which frees the previous one
+ * after a grace period. Writers must be serialized by the caller.
+ *
+ * @tparam T Snapshot type
+ */
+template<typename T>
+class RcuPtr {
+public:
+    explicit RcuPtr(RcuDomain& domain, std::unique_ptr<T> initial = std::make_unique<T>())
+        : domain(domain), ptr(initial.release()) {}
+
+    ~RcuPtr() {
+        delete ptr.load(std::memory_order_relaxed);
+    }
+
+    RcuPtr(const RcuPtr&) = delete;
+    RcuPtr& operator=(const RcuPtr&) = delete;
+
+    /**
+     * @brief Current snapshot, valid until the guard is destroyed
+     */
+    const T* get(const RcuDomain::ReadGuard&) const {
+        return ptr.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Current snapshot for the (serialized) writer
+     */
+    const T* current() const {
+        return ptr.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Publishes a new snapshot and frees the old one once no reader can see it
+     * @param next New snapshot
+     */
+    void replace(std::unique_ptr<T> next) {
+        T* old = ptr.exchange(next.release(), std::memory_order_seq_cst);
+        domain.synchronize();
+        delete old;
+    }
+
+private:
+    RcuDomain& domain;
+    std::atomic<T*> ptr;
+};
+
+} // namespace Utils
+
+#endif
@@ -6,11 +6,16 @@
 #ifndef RUNTIME_CONFIG_HPP
 #define RUNTIME_CONFIG_HPP
 
+#include "FlatHashMap.hpp"
+#include "Rcu.hpp"
 #include <string>
 #include <unordered_map>
 #include <mutex>
 #include <optional>
 #include <climits>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 /**
  * @enum ConfigType
@@ -18,6 +23,40 @@
  */
 enum class ConfigType { INT, BOOL };
 
+/**
+ * @struct ConfigSnapshot
+ * @brief Every configuration value, typed; immutable once published
+ */
+struct ConfigSnapshot {
+    uint64_t version = 0;  ///< Bumped by every change
+
+    int heartbeatIntervalS = 0;      ///< HEARTBEAT_INTERVAL_S
+    int heartbeatCheckDelayS = 0;    ///< HEARTBEAT_CHECK_DELAY_S
+    int heartbeatTimeoutS = 0;       ///< HEARTBEAT_TIMEOUT_S
+    int clientTimeoutS = 0;          ///< CLIENT_TIMEOUT_S
+    int maxQueueSize = 0;            ///< MAX_QUEUE_SIZE
+    int maxQueueKb = 0;              ///< MAX_QUEUE_KB
+    int maxQueueKbPerUser = 0;       ///< MAX_QUEUE_KB_PER_USER
+    int threadPoolSize = 0;          ///< THREAD_POOL_SIZE
+    bool threadPoolAutoscale = false; ///< THREAD_POOL_AUTOSCALE
+    int threadPoolMin = 0;           ///< THREAD_POOL_MIN
+    int threadPoolMax = 0;           ///< THREAD_POOL_MAX
+    int threadPoolTargetWaitMs = 0;  ///< THREAD_POOL_TARGET_WAIT_MS
+    int maxUsernameLength = 0;       ///< MAX_USERNAME_LENGTH
+    int maxSubjectLength = 0;        ///< MAX_SUBJECT_LENGTH
+    bool offlineStoreEnabled = false; ///< OFFLINE_STORE_ENABLED
+    int offlineMaxKbPerUser = 0;     ///< OFFLINE_MAX_KB_PER_USER
+    int offlineMaxMb = 0;            ///< OFFLINE_MAX_MB
+    int offlineTtlH = 0;             ///< OFFLINE_TTL_H
+    bool historyEnabled = false;     ///< HISTORY_ENABLED
+    bool durableSends = false;       ///< DURABLE_SENDS
+    int groupCommitDelayMs = 0;      ///< GROUP_COMMIT_DELAY_MS
+    int logRotateSizeKb = 0;         ///< LOG_ROTATE_SIZE_KB
+    int logRotateAgeMin = 0;         ///< LOG_ROTATE_AGE_MIN
+    int logRotateKeep = 0;           ///< LOG_ROTATE_KEEP
+    bool autoStopWhenNoClients = false; ///< AUTO_STOP_WHEN_NO_CLIENTS
+};
+
 /**
  * @struct ConfigDef
  * @brief Configuration definition with its constraints
@@ -27,11 +66,17 @@ struct ConfigDef {
     std::string defaultValue;
     int minValue = 0;      // For INT only
     int maxValue = INT_MAX; // For INT only
+    int ConfigSnapshot::* intField = nullptr;    // Snapshot field of an INT
+    bool ConfigSnapshot::* boolField = nullptr;  // Snapshot field of a BOOL
 };
 
 /**
  * @class RuntimeConfig
  * @brief Singleton to manage runtime modifiable configurations
+ *
+ * The values live in a ConfigSnapshot behind an RCU pointer: readers take
+ * no lock and parse nothing, writers (set, reset) copy the snapshot, change
+ * it and publish the copy, then call the subscribers.
  */
 class RuntimeConfig {
 public:
@@ -51,6 +96,19 @@ public:
      */
     bool set(const std::string& key, const std::string& value);
 
+    /**
+     * @brief Applies a config file: one `KEY = value` per line, `#` comments
+     *
+     * Every line is checked (syntax, key, range) before anything changes: a
+     * file with an error is rejected as a whole. The values are published as
+     * one snapshot, and subscribers are only called if a value changed. A key
+     * removed from the file since the previous load goes back to its default.
+     * @param path File to read
+     * @param error Set when false is returned ("line N: ...")
+     * @return true if the file was applied
+     */
+    bool loadFile(const std::string& path, std::string& error);
+
     /**
      * @brief Gets an integer value
      * @param key Constant name
@@ -65,6 +123,40 @@ public:
      */
     std::optional<bool> getBool(const std::string& key) const;
 
+    /**
+     * @brief Reads the current snapshot without locking
+     * @param reader Called with the snapshot, which must not escape the call
+     * @return What the reader returns
+     */
+    template<typename Reader>
+    auto read(Reader&& reader) const {
+        Utils::RcuDomain::ReadGuard guard(rcu);
+        return reader(*snapshot.get(guard));
+    }
+
+    /**
+     * @brief Copy of the current snapshot
+     */
+    ConfigSnapshot current() const {
+        return read([](const ConfigSnapshot& config) { return config; });
+    }
+
+    using Subscriber = std::function<void(const ConfigSnapshot&)>;
+
+    /**
+     * @brief Calls the subscriber with the latest snapshot after each change
+     *
+     * Subscribers run on the thread that made the change, one at a time; they
+     * may read the configuration but not change it.
+     * @return Subscription ID for unsubscribe()
+     */
+    size_t subscribe(Subscriber subscriber);
+
+    /**
+     * @brief Removes a subscription; the subscriber is not running when it returns
+     */
+    void unsubscribe(size_t id);
+
     /**
      * @brief Lists all available configurations
      * @return Map of configurations with their current values
@@ -81,10 +173,19 @@ private:
 
     void initializeDefinitions();
     bool validateValue(const std::string& key, const std::string& value, const ConfigDef& def);
+    static void assign(ConfigSnapshot& config, const ConfigDef& def, const std::string& value);
+    static std::string format(const ConfigSnapshot& config, const ConfigDef& def);
+    void notifySubscribers();
+
+    std::mutex configMutex;  ///< Serializes writers
+    Utils::FlatHashMap<std::string, ConfigDef> definitions;  ///< Immutable after construction
+    mutable Utils::RcuDomain rcu;
+    Utils::RcuPtr<ConfigSnapshot> snapshot{rcu};
+    std::vector<std::string> fileKeys;  ///< Set by the last loaded file (under configMutex)
 
-    mutable std::mutex configMutex;
-    std::unordered_map<std::string, std::string> config;
-    std::unordered_map<std::string, ConfigDef> definitions;
+    std::mutex subscribersMutex;
+    std::vector<std::pair<size_t, Subscriber>> subscribers;
+    size_t nextSubscription = 1;
 };
 
 #endif
@@ -0,0 +1,127 @@
+/**
+ * @file Task.hpp
+ * @brief Move-only callable with inline storage for thread pool tasks
+ */
+
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Utils {
+
+/**
+ * @class Task
+ * @brief Type-erased void() callable that is moved, never copied
+ *
+ * Unlike std::function, the callable only has to be movable, so captures
+ * such as std::unique_ptr or std::packaged_task are accepted. Callables of up
+ * to INLINE_SIZE bytes that are nothrow-movable are stored inside the Task
+ * itself; larger ones are moved to the heap.
+ */
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 48;  ///< Task is 64 bytes in total
+
+    Task() noexcept = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& callable) {
+        using Callable = std::decay_t<F>;
+        if constexpr (fitsInline<Callable>()) {
+            ::new (static_cast<void*>(storage)) Callable(std::forward<F>(callable));
+            ops = &inlineOps<Callable>;
+        } else {
+            ::new (static_cast<void*>(storage)) Callable*(new Callable(std::forward<F>(callable)));
+            ops = &heapOps<Callable>;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->move(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->move(storage, other.storage);
+                ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { ops->invoke(storage); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    /**
+     * @brief Whether a callable of this type is stored without allocating
+     */
+    template<typename Callable>
+    static constexpr bool fitsInline() {
+        return sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* to, void* from) noexcept;  ///< Leaves `from` destroyed
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename Callable>
+    static Callable& inlineTarget(void* storage) {
+        return *std::launder(static_cast<Callable*>(storage));
+    }
+
+    template<typename Callable>
+    static Callable*& heapTarget(void* storage) {
+        return *std::launder(static_cast<Callable**>(storage));
+    }
+
+    template<typename Callable>
+    static constexpr Ops inlineOps = {
+        [](void* storage) { inlineTarget<Callable>(storage)(); },
+        [](void* to, void* from) noexcept {
+            ::new (to) Callable(std::move(inlineTarget<Callable>(from)));
+            inlineTarget<Callable>(from).~Callable();
+        },
+        [](void* storage) noexcept { inlineTarget<Callable>(storage).~Callable(); },
+    };
+
+    template<typename Callable>
+    static constexpr Ops heapOps = {
+        [](void* storage) { (*heapTarget<Callable>(storage))(); },
+        [](void* to, void* from) noexcept { ::new (to) Callable*(heapTarget<Callable>(from)); },
+        [](void* storage) noexcept { delete heapTarget<Callable>(storage); },
+    };
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file ThreadPlacement.hpp
+ * @brief CPU pinning and NUMA memory preference per server thread role
+ */
+
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @enum ThreadRole
+ * @brief Server threads that can be placed separately
+ */
+enum class ThreadRole { ACCEPT, DISPATCHER, EVENTS, HEARTBEAT, MONITOR, POOL };
+
+constexpr size_t THREAD_ROLE_COUNT = 6;
+
+/**
+ * @class ThreadPlacement
+ * @brief Where each server thread runs
+ *
+ * Built from the command line:
+ *  - `role=cpulist` pins a role (accept, dispatcher, events, heartbeat,
+ *    monitor, pool) to CPUs in the kernel's list format ("0-3,8");
+ *    pool workers are pinned one CPU each, round-robin over their list;
+ *  - `auto` spreads the roles over the CPUs this process may use: the
+ *    dispatcher and the epoll loop get a CPU each, the low-rate threads share
+ *    a third and the pool gets the rest (everything shares when fewer than
+ *    four CPUs are available);
+ *  - irqCpus (the CPUs handling NIC interrupts) are left out of `auto` and
+ *    of the roles without an explicit list.
+ *
+ * Once anything is set, roles without a list get every CPU the process had
+ * when the placement was built, since a thread inherits its creator's mask.
+ * The admin thread is never placed: /upgrade starts the next process from it.
+ *
+ * A thread whose CPUs all sit on one NUMA node also prefers that node for
+ * its memory, so the buffers it allocates for a connection are local to it.
+ * Without any setting, apply() only names the thread.
+ */
+class ThreadPlacement {
+public:
+    ThreadPlacement();
+
+    /**
+     * @brief Adds a `role=cpulist` or `auto` setting
+     * @return false (with error set) if the setting is invalid
+     */
+    bool parse(const std::string& spec, std::string& error);
+
+    /**
+     * @brief Sets the CPUs reserved for interrupts
+     * @return false (with error set) if the list is invalid
+     */
+    bool setIrqCpus(const std::string& list, std::string& error);
+
+    /**
+     * @brief Pins the calling thread for its role
+     * @param role Role of the thread
+     * @param index Worker index for ThreadRole::POOL
+     */
+    void apply(ThreadRole role, size_t index = 0) const;
+
+    /**
+     * @brief Command line arguments that recreate this placement (for /upgrade)
+     */
+    std::vector<std::string> arguments() const;
+
+    /**
+     * @brief One-line summary for the log, empty without any setting
+     */
+    std::string describe() const;
+
+    /**
+     * @brief Parses a kernel CPU list such as "0-3,8"
+     * @return The CPUs, empty if the list is invalid
+     */
+    static std::vector<int> parseCpuList(const std::string& list);
+
+    static const char* roleName(ThreadRole role);
+
+private:
+    std::vector<int> cpusFor(ThreadRole role) const;
+    std::vector<int> availableCpus() const;
+    std::vector<int> automaticCpus(ThreadRole role) const;
+
+    std::vector<int> processCpus;  ///< Allowed at construction, grouped by NUMA node
+    std::array<std::vector<int>, THREAD_ROLE_COUNT> explicitCpus;
+    std::vector<int> irqCpus;
+    bool automatic = false;
+    std::vector<std::string> specs;  ///< As given, for arguments()
+    std::string irqList;
+};
+
+} // namespace Utils
+
+#endif
@@ -11,8 +11,9 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
+#include <future>
 #include <atomic>
+#include "Task.hpp"
 
 /**
  * @class ThreadPool
@@ -36,15 +37,27 @@ public:
     
     /**
      * @brief Adds a task to the queue
-     * @param task Function to execute
+     * @param task Function to execute (moved, may hold move-only captures)
      */
-    void enqueue(std::function<void()> task);
+    void enqueue(Utils::Task task);
+    
+    /**
+     * @brief Adds a task whose result is wanted
+     * @param task Packaged function to execute
+     * @return Future set to the result (or exception) once it ran
+     */
+    template<typename R>
+    std::future<R> enqueue(std::packaged_task<R()> task) {
+        std::future<R> result = task.get_future();
+        enqueue(Utils::Task(std::move(task)));
+        return result;
+    }
     
 private:
     void workerThread();
     
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    std::queue<Utils::Task> tasks;
     std::mutex queueMutex;
     std::condition_variable condition;
     std::atomic<bool> stop;
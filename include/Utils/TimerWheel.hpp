@@ -0,0 +1,300 @@
+/**
+ * @file TimerWheel.hpp
+ * @brief Hierarchical timing wheel with O(1) insert and cancel
+ */
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @class TimerWheel
+ * @brief Hashed hierarchical timing wheel (4 levels x 256 slots)
+ *
+ * Timers are stored in a slab of nodes linked into per-slot intrusive lists,
+ * so schedule() and cancel() are O(1) and the wheel can hold millions of
+ * pending timers without per-timer allocations. Level 0 has the resolution of
+ * one tick; each upper level covers 256 times the range of the level below and
+ * is cascaded down when the lower level wraps. Not thread-safe: the owner
+ * serializes access.
+ *
+ * @tparam T Payload returned to the caller when the timer expires
+ */
+template<typename T>
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;  ///< 0 is never a valid id
+
+    /**
+     * @brief Constructor
+     * @param tick Resolution of the wheel
+     * @param origin Time point of tick 0
+     */
+    explicit TimerWheel(std::chrono::milliseconds tick, Clock::time_point origin = Clock::now())
+        : tickDuration(tick), origin(origin) {
+        for (auto& level : heads) {
+            level.fill(NIL);
+        }
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Arms a timer
+     * @param when Expiry time (rounded up to the next tick)
+     * @param payload Value handed back on expiry
+     * @return Handle usable with cancel()
+     */
+    TimerId schedule(Clock::time_point when, T payload) {
+        uint32_t index = allocateNode();
+        Node& node = nodes[index];
+        node.expiry = std::max(toTick(when), currentTick + 1);
+        node.payload.emplace(std::move(payload));
+        link(index);
+        ++count;
+        return (static_cast<uint64_t>(node.generation) << 32) | index;
+    }
+
+    /**
+     * @brief Disarms a pending timer
+     * @param id Handle returned by schedule()
+     * @return true if the timer was pending
+     */
+    bool cancel(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (id == 0 || index >= nodes.size()) {
+            return false;
+        }
+
+        Node& node = nodes[index];
+        if (!node.linked || node.generation != generation) {
+            return false;
+        }
+
+        unlink(index);
+        releaseNode(index);
+        --count;
+        return true;
+    }
+
+    /**
+     * @brief Moves the wheel forward and fires every timer due by @p now
+     * @param now Current time
+     * @param onExpire Callable receiving the payload (T&&) of each expired timer
+     * @return Number of fired timers
+     *
+     * The callback may schedule or cancel other timers.
+     */
+    template<typename Callback>
+    size_t advance(Clock::time_point now, Callback&& onExpire) {
+        uint64_t target = toTickFloor(now);
+        size_t fired = 0;
+
+        while (currentTick < target && count > 0) {
+            ++currentTick;
+            cascade();
+
+            // Unlink one node at a time so the callback may cancel its neighbours
+            uint32_t& head = heads[0][currentTick & SLOT_MASK];
+            while (head != NIL) {
+                uint32_t index = head;
+                unlink(index);
+                T payload = std::move(*nodes[index].payload);
+                releaseNode(index);
+                --count;
+                ++fired;
+                onExpire(std::move(payload));
+            }
+        }
+
+        // Nothing pending: jump straight to the present
+        if (count == 0 && currentTick < target) {
+            currentTick = target;
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Disarms every pending timer, handing its payload to the caller
+     * @param onRemove Callable receiving the payload (T&&) of each timer
+     * @return Number of removed timers
+     */
+    template<typename Callback>
+    size_t drain(Callback&& onRemove) {
+        size_t removed = 0;
+        for (uint32_t index = 0; index < nodes.size(); ++index) {
+            if (!nodes[index].linked) {
+                continue;
+            }
+            unlink(index);
+            T payload = std::move(*nodes[index].payload);
+            releaseNode(index);
+            --count;
+            ++removed;
+            onRemove(std::move(payload));
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Earliest time at which advance() may have work to do
+     * @return Time point, or std::nullopt if no timer is pending
+     *
+     * Exact for timers in the lowest level; otherwise returns the next cascade.
+     */
+    std::optional<Clock::time_point> nextExpiry() const {
+        if (count == 0) {
+            return std::nullopt;
+        }
+
+        for (uint64_t tick = currentTick + 1; tick <= currentTick + SLOTS; ++tick) {
+            if (heads[0][tick & SLOT_MASK] != NIL) {
+                return toTime(tick);
+            }
+            if ((tick & SLOT_MASK) == 0) {
+                return toTime(tick);  // Level 1 cascades here
+            }
+        }
+        return toTime(currentTick + SLOTS);
+    }
+
+    /**
+     * @brief Number of pending timers
+     */
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr uint64_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    struct Node {
+        uint64_t expiry = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool linked = false;
+        std::optional<T> payload;
+    };
+
+    uint64_t toTick(Clock::time_point when) const {
+        if (when <= origin) {
+            return 0;
+        }
+        auto elapsed = when - origin;
+        auto ticks = elapsed / tickDuration;
+        return static_cast<uint64_t>(ticks) + ((elapsed % tickDuration).count() != 0 ? 1 : 0);
+    }
+
+    uint64_t toTickFloor(Clock::time_point when) const {
+        return when <= origin ? 0 : static_cast<uint64_t>((when - origin) / tickDuration);
+    }
+
+    Clock::time_point toTime(uint64_t tick) const {
+        return origin + tickDuration * static_cast<int64_t>(tick);
+    }
+
+    uint32_t allocateNode() {
+        if (!freeList.empty()) {
+            uint32_t index = freeList.back();
+            freeList.pop_back();
+            return index;
+        }
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    void releaseNode(uint32_t index) {
+        Node& node = nodes[index];
+        node.payload.reset();
+        node.linked = false;
+        node.generation = node.generation == UINT32_MAX ? 1 : node.generation + 1;
+        freeList.push_back(index);
+    }
+
+    void link(uint32_t index) {
+        Node& node = nodes[index];
+        uint64_t delta = node.expiry - currentTick;
+
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (SLOTS << (SLOT_BITS * level))) {
+            ++level;
+        }
+
+        uint64_t expiry = node.expiry;
+        if (delta >= (SLOTS << (SLOT_BITS * (LEVELS - 1)))) {
+            // Beyond the wheel range: park in the farthest slot, re-cascaded later
+            expiry = currentTick + (SLOTS << (SLOT_BITS * (LEVELS - 1))) - 1;
+        }
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>((expiry >> (SLOT_BITS * level)) & SLOT_MASK);
+        node.prev = NIL;
+        node.next = heads[level][node.slot];
+        if (node.next != NIL) {
+            nodes[node.next].prev = index;
+        }
+        heads[level][node.slot] = index;
+        node.linked = true;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes[index];
+        if (node.prev != NIL) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.level][node.slot] = node.next;
+        }
+        if (node.next != NIL) {
+            nodes[node.next].prev = node.prev;
+        }
+        node.prev = node.next = NIL;
+        node.linked = false;
+    }
+
+    void cascade() {
+        for (int level = 1; level < LEVELS; ++level) {
+            if ((currentTick & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) != 0) {
+                break;
+            }
+
+            uint8_t slot = static_cast<uint8_t>((currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+            uint32_t index = heads[level][slot];
+            heads[level][slot] = NIL;
+
+            while (index != NIL) {
+                uint32_t next = nodes[index].next;
+                link(index);
+                index = next;
+            }
+        }
+    }
+
+    std::chrono::milliseconds tickDuration;
+    Clock::time_point origin;
+    uint64_t currentTick = 0;
+    size_t count = 0;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeList;
+    std::array<std::array<uint32_t, SLOTS>, LEVELS> heads;
+};
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * @file WorkStealingPool.hpp
+ * @brief Thread pool with per-worker Chase-Lev deques and a global injection queue
+ */
+
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Task.hpp"
+
+/**
+ * @class WorkStealingPool
+ * @brief Drop-in replacement for ThreadPool that keeps workers off a shared lock
+ *
+ * A task enqueued by a worker goes to that worker's own deque (no lock, LIFO
+ * for the owner, so follow-up work runs while its data is still in cache);
+ * a task enqueued from any other thread goes to the global injection queue.
+ * An idle worker pops its own deque, then takes from the injection queue,
+ * then steals the oldest task of another worker. Workers with nothing to do
+ * sleep on a condition variable and are woken only when someone is asleep.
+ *
+ * The pool can be resized while running. Workers live in fixed slots so
+ * thieves never see them move; a worker whose slot falls outside the new size
+ * finishes its current task and its own deque, then exits.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Constructor
+     * @param numThreads Number of threads in the pool
+     * @param onWorkerStart Called first on every worker thread, with its index
+     *        (also for the workers a later resize() starts)
+     */
+    explicit WorkStealingPool(size_t numThreads, std::function<void(size_t)> onWorkerStart = {});
+
+    static constexpr size_t MAX_THREADS = 1024;  ///< Upper bound for resize()
+
+    /**
+     * @brief Destructor (waits for tasks to complete)
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Adds a task to the queue
+     * @param task Function to execute (moved, may hold move-only captures)
+     */
+    void enqueue(Utils::Task task);
+
+    /**
+     * @brief Adds a task whose result is wanted
+     * @param task Packaged function to execute
+     * @return Future set to the result (or exception) once it ran
+     */
+    template<typename R>
+    std::future<R> enqueue(std::packaged_task<R()> task) {
+        std::future<R> result = task.get_future();
+        enqueue(Utils::Task(std::move(task)));
+        return result;
+    }
+
+    /**
+     * @brief Grows or shrinks the pool
+     * @param numThreads New number of workers (clamped to 1..MAX_THREADS)
+     *
+     * Growing starts threads at once; a worker above the new size exits once
+     * its running task and its own deque are done, so a long task delays it.
+     */
+    void resize(size_t numThreads);
+
+    /**
+     * @brief Number of workers the pool is sized for
+     */
+    size_t size() const { return target.load(std::memory_order_relaxed); }
+
+    /**
+     * @struct WorkerStats
+     * @brief Counters of one worker since it started
+     */
+    struct WorkerStats {
+        size_t index;
+        uint64_t tasks;
+        double utilization;  ///< Busy fraction of its lifetime, running task included
+        bool retiring;       ///< Above the current size, finishing its work
+    };
+
+    /**
+     * @struct Stats
+     * @brief Snapshot for /stats
+     */
+    struct Stats {
+        size_t size;
+        size_t queued;
+        uint64_t completed;
+        double avgWaitMs;  ///< Time from enqueue() to start, all tasks so far
+        double maxWaitMs;
+        std::vector<WorkerStats> workers;
+    };
+
+    Stats getStats() const;
+
+    /**
+     * @struct Sample
+     * @brief Activity since the previous sample() call
+     */
+    struct Sample {
+        uint64_t tasks;      ///< Tasks started in the interval
+        double avgWaitMs;    ///< Their average queue wait
+        size_t queued;       ///< Tasks waiting right now
+        double utilization;  ///< Busy fraction of the live workers over the interval
+    };
+
+    /**
+     * @brief Measures the interval since the previous call (one caller only)
+     */
+    Sample sample();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        Utils::Task run;
+        Clock::time_point enqueued;
+    };
+
+    /**
+     * @class Deque
+     * @brief Chase-Lev work-stealing deque (Lê et al., PPoPP 2013)
+     *
+     * push() and pop() are called by the owning worker only; steal() by any
+     * thread. The ring grows by doubling; replaced rings are kept until the
+     * deque is destroyed, since a thief may still be reading one.
+     */
+    class Deque {
+    public:
+        Deque();
+        ~Deque();
+
+        void push(Job* task);
+        Job* pop();
+        Job* steal();
+        bool empty() const;
+        size_t size() const;
+
+    private:
+        struct Ring {
+            explicit Ring(int64_t capacity) : capacity(capacity), slots(new std::atomic<Job*>[capacity]) {}
+            Job* get(int64_t index) const { return slots[index & (capacity - 1)].load(std::memory_order_relaxed); }
+            void put(int64_t index, Job* task) { slots[index & (capacity - 1)].store(task, std::memory_order_relaxed); }
+
+            const int64_t capacity;
+            std::unique_ptr<std::atomic<Job*>[]> slots;
+        };
+
+        Ring* grow(Ring* ring, int64_t bottom, int64_t top);
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Ring*> ring;
+        std::vector<std::unique_ptr<Ring>> rings;  // Owner only
+    };
+
+    // Counters are written by the worker only and read by anyone
+    struct Worker {
+        Deque deque;
+        std::thread thread;
+        bool exited = false;  ///< Under queueMutex
+        Clock::time_point started;
+        uint64_t busyAtStart = 0;
+        uint64_t tasksAtStart = 0;
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> waitNs{0};
+        std::atomic<uint64_t> maxWaitNs{0};
+        std::atomic<int64_t> runningSince{0};  ///< Start of the current task (ns), 0 when idle
+    };
+
+    void startWorker(size_t index);
+    void workerThread(size_t index);
+    void runTask(Worker& worker, Job* task);
+    Job* findTask(size_t index, bool retiring);
+    Job* takeInjected();
+    void wakeOne();
+    size_t queued() const;
+
+    // Slots below highWater are allocated and never freed before the pool
+    std::array<std::unique_ptr<Worker>, MAX_THREADS> workers;
+    std::function<void(size_t)> onWorkerStart;
+    std::atomic<size_t> highWater{0};
+    std::atomic<size_t> target{0};
+
+    mutable std::mutex queueMutex;  ///< Injection queue, sleeping workers, worker lifecycle
+    std::condition_variable condition;
+    std::deque<Job*> injected;
+    std::atomic<size_t> injectedCount{0};
+    std::atomic<size_t> sleeping{0};
+    std::atomic<bool> stop{false};
+
+    // sample() state
+    Clock::time_point lastSample;
+    uint64_t lastTasks = 0;
+    uint64_t lastWaitNs = 0;
+    uint64_t lastBusyNs = 0;
+};
+
+#endif
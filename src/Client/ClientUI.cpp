@@ -8,6 +8,7 @@
 #include "Utils/Utils.hpp"
 #include "Utils/MessageParser.hpp"
 #include "Utils/Colors.hpp"
+#include "Utils/Constants.hpp"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
@@ -22,6 +23,7 @@ ClientUI::ClientUI(Client& client, const std::string& serverIp, int serverPort)
     commands["4"] = [this]() { cmdListUsers(); };
     commands["5"] = [this]() { cmdSendMessage(true); };
     commands["6"] = [this]() { cmdGetLog(); };
+    commands["7"] = [this]() { cmdHistory(); };
 }
 
 // === Affichage ===
@@ -60,7 +62,8 @@ void ClientUI::printMenu() {
     std::cout << "4. Online users\n";
     std::cout << "5. Broadcast\n";
     std::cout << "6. Server logs\n";
-    std::cout << Color::BRIGHT_RED << "7. Quit" << Color::RESET << "\n";
+    std::cout << "7. History\n";
+    std::cout << Color::BRIGHT_RED << "8. Quit" << Color::RESET << "\n";
     std::cout << Color::YELLOW << "$ " << Color::RESET;
 }
 
@@ -82,6 +85,14 @@ void ClientUI::printUserList(const std::string& userListData) {
     }
 }
 
+void ClientUI::printHistoryEntry(const ServerEventData& event) {
+    // args: seq, from, to, subject, body, timestamp
+    auto timestamp = Utils::unixStringToTimestamp(event.args[5]);
+    std::cout << Color::CYAN << "#" << event.args[0] << Color::RESET << " "
+              << Utils::formatTimestamp(timestamp) << " " << event.args[1] << " -> " << event.args[2]
+              << " | " << event.args[3] << ": " << event.args[4] << "\n";
+}
+
 // === Connexion ===
 
 bool ClientUI::promptAndConnect() {
@@ -197,12 +208,37 @@ void ClientUI::cmdListUsers() {
 void ClientUI::cmdGetLog() {
     auto* handler = client.getMessageHandler();
     if (handler) {
-        handler->sendCommand(Utils::MessageParser::build("GET_LOG"));
+        std::cout << "From cursor (Enter = latest): ";
+        std::string cursor;
+        std::getline(std::cin, cursor);
+        handler->sendCommand(cursor.empty() ? Utils::MessageParser::build("GET_LOG")
+                                            : Utils::MessageParser::build("GET_LOG", cursor));
         // Wait for server response
         waitForResponse(ServerEvent::LOG);
     }
 }
 
+void ClientUI::cmdHistory() {
+    auto* handler = client.getMessageHandler();
+    if (!handler) return;
+    
+    std::cout << "From sequence number (Enter = latest): ";
+    std::string start;
+    std::getline(std::cin, start);
+    
+    uint64_t startSeq = 0;
+    try {
+        startSeq = start.empty() ? 0 : std::stoull(start);
+    } catch (...) {
+        printError("Invalid sequence number");
+        return;
+    }
+    
+    handler->requestHistory(startSeq, Constants::HISTORY_PAGE_SIZE);
+    // Wait for the end of the page
+    waitForResponse(ServerEvent::HISTORY_END);
+}
+
 // === Event handling ===
 
 void ClientUI::waitForResponse(ServerEvent expectedType, int timeoutMs) {
@@ -270,7 +306,22 @@ void ClientUI::displayEvent(const ServerEventData& event) {
             break;
         case ServerEvent::LOG:
             std::cout << "\n" << Color::BRIGHT_CYAN << "=== LOG ===" << Color::RESET << "\n";
-            std::cout << event.data << "\n$ " << std::flush;
+            std::cout << event.data << "\n";
+            if (!event.args.empty() && !event.args[0].empty()) {
+                std::cout << Color::GRAY << "Older lines from cursor " << event.args[0] << Color::RESET << "\n";
+            }
+            std::cout << "$ " << std::flush;
+            break;
+        case ServerEvent::HISTORY:
+            printHistoryEntry(event);
+            break;
+        case ServerEvent::HISTORY_END:
+            if (event.args[1] == "0") {
+                std::cout << Color::YELLOW << "No messages." << Color::RESET << "\n";
+            } else if (event.args[0] != "0") {
+                std::cout << Color::GRAY << "Next page starts at #" << event.args[0] << Color::RESET << "\n";
+            }
+            std::cout << "$ " << std::flush;
             break;
         default:
             break;
@@ -299,6 +350,12 @@ void ClientUI::displayPendingEvents() {
             case ServerEvent::LOG:
                 std::cout << Color::BRIGHT_CYAN << "=== LOG ===" << Color::RESET << "\n";
                 std::cout << event.data << "\n";
+                if (!event.args.empty() && !event.args[0].empty()) {
+                    std::cout << Color::GRAY << "Older lines from cursor " << event.args[0] << Color::RESET << "\n";
+                }
+                break;
+            case ServerEvent::HISTORY:
+                printHistoryEntry(event);
                 break;
             default:
                 break;
@@ -334,7 +391,7 @@ bool ClientUI::run() {
         inCommand.store(true);
         clearScreen();
         
-        if (choice == "7") {
+        if (choice == "8") {
             std::cout << Color::YELLOW << "Disconnecting..." << Color::RESET << "\n";
             running = false;
         } else {
@@ -9,6 +9,10 @@
 #include "Utils/Logger.hpp"
 #include "Utils/NetworkStream.hpp"
 #include "Utils/MessageParser.hpp"
+#ifdef ENABLE_COROUTINES
+#include "Utils/IoLoop.hpp"
+#include <future>
+#endif
 
 MessageHandler::MessageHandler(int socketFd) : socketFd(socketFd) {
     //LOG_DEBUG("MessageHandler created for socket " + std::to_string(socketFd));
@@ -37,6 +41,36 @@ bool MessageHandler::sendCommand(const std::string& command) {
     return true;
 }
 
+bool MessageHandler::requestHistory(uint64_t start, int count) {
+    return sendCommand(Utils::MessageParser::build("HISTORY", "seq", std::to_string(start), std::to_string(count)));
+}
+
+#ifdef ENABLE_COROUTINES
+void MessageHandler::listen(EventCallback onEvent) {
+    Utils::IoLoop loop(1);
+    if (!loop.isOpen()) {
+        return;
+    }
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    listenAsync(loop, std::move(onEvent), std::move(done));
+    finished.wait();
+}
+
+Utils::Detached MessageHandler::listenAsync(Utils::IoLoop& loop, EventCallback onEvent, std::promise<void> done) {
+    Utils::AsyncStream stream(loop, socketFd);
+    
+    while (stream.isConnected()) {
+        auto message = co_await stream.receive();
+        if (!message) {
+            LOG_INFO("Connection closed");
+            break;
+        }
+        handleFrame(*message, onEvent);
+    }
+    done.set_value();
+}
+#else
 void MessageHandler::listen(EventCallback onEvent) {
     Network::NetworkStream stream(socketFd);
     
@@ -46,24 +80,30 @@ void MessageHandler::listen(EventCallback onEvent) {
             LOG_INFO("Connection closed");
             break;
         }
-        
-        auto event = parseMessage(*message);
-        if (event) {
-            // Store received messages
-            if (event->type == ServerEvent::MESSAGE) {
-                storeMessage(*event);
-            }
-            // Automatically reply to PING
-            else if (event->type == ServerEvent::PING) {
-                sendCommand(Utils::MessageParser::build("PONG"));
-                LOG_DEBUG("PING received, PONG sent");
-                continue;  // No need to notify UI
-            }
-            
-            if (onEvent) {
-                onEvent(*event);
-            }
-        }
+        handleFrame(*message, onEvent);
+    }
+}
+#endif
+
+void MessageHandler::handleFrame(const std::string& raw, const EventCallback& onEvent) {
+    auto event = parseMessage(raw);
+    if (!event) {
+        return;
+    }
+    
+    // Store received messages
+    if (event->type == ServerEvent::MESSAGE) {
+        storeMessage(*event);
+    }
+    // Automatically reply to PING
+    else if (event->type == ServerEvent::PING) {
+        sendCommand(Utils::MessageParser::build("PONG"));
+        LOG_DEBUG("PING received, PONG sent");
+        return;  // No need to notify UI
+    }
+    
+    if (onEvent) {
+        onEvent(*event);
     }
 }
 
@@ -93,8 +133,21 @@ std::optional<ServerEventData> MessageHandler::parseMessage(const std::string& r
         event.data = parsed.arg(0);
     }
     else if (parsed.command == "LOG" && parsed.argCount() >= 1) {
+        // LOG;lines;cursor - the lines may contain the delimiter, the cursor never does
         event.type = ServerEvent::LOG;
-        event.data = parsed.arg(0);
+        size_t last = parsed.argCount() > 1 ? parsed.argCount() - 1 : 1;
+        for (size_t i = 0; i < last; ++i) {
+            event.data += (i > 0 ? Constants::MESSAGE_DELIMITER : "") + parsed.arg(i);
+        }
+        event.args = {parsed.argCount() > 1 ? parsed.arg(last) : ""};
+    }
+    else if (parsed.command == "HISTORY" && parsed.argCount() >= 6) {
+        event.type = ServerEvent::HISTORY;
+        event.args = {parsed.arg(0), parsed.arg(1), parsed.arg(2), parsed.arg(3), parsed.arg(4), parsed.arg(5)};
+    }
+    else if (parsed.command == "HISTORY_END" && parsed.argCount() >= 2) {
+        event.type = ServerEvent::HISTORY_END;
+        event.args = {parsed.arg(0), parsed.arg(1)};
     }
     else if (parsed.command == "PING") {
         event.type = ServerEvent::PING;
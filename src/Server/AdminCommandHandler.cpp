@@ -32,7 +32,9 @@ void AdminCommandHandler::initializeCommands() {
     reg("set",       &AdminCommandHandler::cmdSet,       "/set <name> <value>",    "Modify a config",          2);
     reg("config",    &AdminCommandHandler::cmdConfig,    "/config",                "List configurations",      0);
     reg("reset",     &AdminCommandHandler::cmdReset,     "/reset",                 "Reset configurations",     0);
+    reg("loglevel",  &AdminCommandHandler::cmdLogLevel,  "/loglevel [level]",      "Show or set the minimum log level", 0);
     reg("stop",      &AdminCommandHandler::cmdStop,      "/stop",                  "Stop the server",          0);
+    reg("upgrade",   &AdminCommandHandler::cmdUpgrade,   "/upgrade [binary]",      "Hand clients to a new binary", 0);
 }
 
 void AdminCommandHandler::commandLoop() {
@@ -87,21 +89,21 @@ void AdminCommandHandler::cmdBroadcast(const std::vector<std::string>& args) {
         message += args[i];
     }
     
-    auto clients = server->getAllClients();
-    if (clients.empty()) {
+    auto sessions = server->getAllSessions();
+    if (sessions.empty()) {
         std::cout << "[Admin] No clients connected\n";
         return;
     }
     
-    int sent = 0;
-    for (const auto& [username, socket] : clients) {
-        Network::NetworkStream stream(socket);
-        if (stream.send(Utils::MessageParser::build("MESSAGE", "SERVER", "Announcement", message, "0"))) {
-            sent++;
+    auto dispatcher = server->getDispatcher();
+    int queued = 0;
+    for (const auto& session : sessions) {
+        if (dispatcher && dispatcher->queueMessage(makeAdminMessage(session, "Announcement", message))) {
+            queued++;
         }
     }
     
-    std::cout << "[Admin] Broadcast sent to " << sent << " client(s)\n";
+    std::cout << "[Admin] Broadcast queued for " << queued << " client(s)\n";
     LOG_INFO("Admin broadcast: " + message);
 }
 
@@ -115,15 +117,15 @@ void AdminCommandHandler::cmdSend(const std::vector<std::string>& args) {
         message += args[i];
     }
     
-    int socket = server->getUserSocket(username);
-    if (socket <= 0) {
+    auto session = server->getSession(username);
+    if (!session) {
         std::cout << "[Admin] User '" << username << "' not found\n";
         return;
     }
     
-    Network::NetworkStream stream(socket);
-    if (stream.send(Utils::MessageParser::build("MESSAGE", "SERVER", "Private Message", message, "0"))) {
-        std::cout << "[Admin] Message sent to " << username << "\n";
+    auto dispatcher = server->getDispatcher();
+    if (dispatcher && dispatcher->queueMessage(makeAdminMessage(session, "Private Message", message))) {
+        std::cout << "[Admin] Message queued for " << username << "\n";
         LOG_INFO("Admin message to " + username + ": " + message);
     } else {
         std::cout << "[Admin] Failed to send\n";
@@ -204,6 +206,58 @@ void AdminCommandHandler::cmdStats(const std::vector<std::string>&) {
     std::cout << "Messages/min:      " << std::fixed << std::setprecision(2) << avgMessagesPerMinute << "\n";
     std::cout << "===================================\n";
     
+    if (auto dispatcher = server->getDispatcher()) {
+        auto stats = dispatcher->getStats();
+        std::cout << "Queued messages:   " << stats.totalQueued << " (scheduled: " << stats.scheduled
+                  << ", timers: " << stats.pendingTimers << ")\n";
+        std::cout << "Queued memory:     " << stats.queuedBytes / 1024 << " KB / "
+                  << stats.maxQueuedBytes / 1024 << " KB (per user: "
+                  << stats.maxQueuedBytesPerRecipient / 1024 << " KB)\n";
+        std::cout << "  " << std::left << std::setw(10) << "class"
+                  << std::right << std::setw(8) << "depth" << std::setw(10) << "mailboxes"
+                  << std::setw(10) << "KB" << std::setw(10) << "delivered" << std::setw(9) << "dropped" << std::setw(9) << "expired"
+                  << std::setw(10) << "avg(ms)" << std::setw(10) << "max(ms)" << "\n";
+        for (size_t i = 0; i < MESSAGE_PRIORITY_COUNT; ++i) {
+            const auto& cls = stats.classes[i];
+            std::cout << "  " << std::left << std::setw(10) << Dispatcher::priorityName(static_cast<MessagePriority>(i))
+                      << std::right << std::setw(8) << cls.depth << std::setw(10) << cls.mailboxes
+                      << std::setw(10) << cls.bytes / 1024 << std::setw(10) << cls.delivered << std::setw(9) << cls.dropped << std::setw(9) << cls.expired
+                      << std::setw(10) << cls.avgLatencyMs << std::setw(10) << cls.maxLatencyMs << "\n";
+        }
+        std::cout << std::left << "===================================\n";
+    }
+    
+    if (auto pool = server->getThreadPool()) {
+        auto stats = pool->getStats();
+        std::cout << "Thread pool:       " << stats.size << " worker(s), " << stats.queued << " queued, "
+                  << stats.completed << " task(s), wait avg " << std::fixed << std::setprecision(2)
+                  << stats.avgWaitMs << " ms / max " << stats.maxWaitMs << " ms\n";
+        std::cout << "  " << std::left << std::setw(10) << "worker"
+                  << std::right << std::setw(10) << "tasks" << std::setw(10) << "busy(%)" << "\n";
+        for (const auto& worker : stats.workers) {
+            std::cout << "  " << std::left << std::setw(10) << worker.index
+                      << std::right << std::setw(10) << worker.tasks << std::setw(10) << std::setprecision(1)
+                      << worker.utilization * 100.0 << (worker.retiring ? "  (retiring)" : "") << "\n";
+        }
+        std::cout << std::left << "===================================\n";
+    }
+    
+    if (auto store = server->getOfflineStore()) {
+        auto stats = store->getStats();
+        std::cout << "Offline store:     " << stats.pending << " pending for " << stats.recipients
+                  << " user(s), " << stats.segments << " segment(s), " << stats.diskBytes / 1024 << " KB\n";
+        std::cout << "Mail budgets:      " << stats.storedBytes / 1024 << " KB stored, " << stats.rejected
+                  << " rejected, " << stats.expired << " expired\n";
+        std::cout << "Recovery:          " << stats.recovered << " message(s) in "
+                  << std::fixed << std::setprecision(1) << stats.recoveryMs << " ms\n";
+        if (stats.syncs > 0) {
+            std::cout << "Group commit:      " << stats.syncs << " fsync(s), "
+                      << std::setprecision(1) << static_cast<double>(stats.syncedRecords) / stats.syncs
+                      << " record(s) per batch\n";
+        }
+        std::cout << "===================================\n";
+    }
+    
     if (!clients.empty()) {
         std::cout << "\nOnline clients:\n";
         int i = 1;
@@ -240,14 +294,51 @@ void AdminCommandHandler::cmdReset(const std::vector<std::string>&) {
     std::cout << "[OK] Configurations reset\n";
 }
 
+void AdminCommandHandler::cmdLogLevel(const std::vector<std::string>& args) {
+    Logger& logger = Logger::getInstance();
+    if (args.size() < 2) {
+        std::cout << "Minimum log level: " << Logger::levelName(logger.getMinimumLevel()) << "\n";
+        return;
+    }
+    
+    LogLevel level;
+    if (!Logger::parseLevel(args[1], level)) {
+        std::cout << "[FAILED] Unknown level " << args[1] << " (debug, info, warning, error)\n";
+        return;
+    }
+    logger.setMinimumLevel(level);
+    std::cout << "[OK] Minimum log level: " << Logger::levelName(level) << "\n";
+}
+
 void AdminCommandHandler::cmdStop(const std::vector<std::string>&) {
     std::cout << "Stopping server...\n";
     running = false;
     server->stop();
 }
 
+void AdminCommandHandler::cmdUpgrade(const std::vector<std::string>& args) {
+    std::string binary = args.size() > 1 ? args[1] : "";
+    std::cout << "[Admin] Handing clients over to a new server process...\n";
+    
+    // Only returns if the upgrade was aborted
+    if (!server->upgrade(binary)) {
+        std::cout << "[Admin] Upgrade aborted, still serving (see " << Constants::DEFAULT_SERVER_LOG << ")\n";
+    }
+}
+
 // === Helpers ===
 
+Message AdminCommandHandler::makeAdminMessage(const std::shared_ptr<Session>& to, const std::string& subject, const std::string& body) {
+    Message msg;
+    msg.from = "SERVER";
+    msg.to = to->getUsername();
+    msg.recipient = to;
+    msg.subject = subject;
+    msg.body = body;
+    msg.priority = MessagePriority::ADMIN;
+    return msg;
+}
+
 bool AdminCommandHandler::disconnectUser(const std::string& username, const std::string& reason) {
     int socket = server->getUserSocket(username);
     
@@ -260,6 +351,6 @@ bool AdminCommandHandler::disconnectUser(const std::string& username, const std:
     (void)stream.send(Utils::MessageParser::build("ERROR", reason));
     
     server->unregisterClient(username);
-    close(socket);
+    server->closeClientSocket(socket);
     return true;
 }
@@ -0,0 +1,189 @@
+#include "Server/Banlist.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Constants.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+Banlist::Banlist(std::string path)
+    : path(std::move(path)), journalPath(this->path + ".journal") {
+    for (auto& shard : shards) {
+        shard = std::make_unique<Utils::RcuPtr<Shard>>(rcu);
+    }
+}
+
+Banlist::~Banlist() {
+    if (journalFd >= 0) {
+        ::close(journalFd);
+    }
+}
+
+size_t Banlist::shardOf(const std::string& username) {
+    return std::hash<std::string>{}(username) % SHARDS;
+}
+
+bool Banlist::load() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::vector<std::unique_ptr<Shard>> loaded(SHARDS);
+    for (auto& shard : loaded) {
+        shard = std::make_unique<Shard>();
+    }
+
+    std::ifstream snapshot(path);
+    std::string line;
+    if (snapshot.is_open()) {
+        while (std::getline(snapshot, line)) {
+            if (!line.empty()) {
+                loaded[shardOf(line)]->insert(line);
+            }
+        }
+    } else {
+        LOG_INFO("No banlist file found, creating a new list");
+    }
+
+    // Replay the changes made since the last compaction
+    std::ifstream journal(journalPath);
+    journalEntries = 0;
+    while (journal.is_open() && std::getline(journal, line)) {
+        if (line.size() < 2 || (line[0] != '+' && line[0] != '-')) {
+            continue;  // Torn or foreign line
+        }
+        std::string username = line.substr(1);
+        Shard& shard = *loaded[shardOf(username)];
+        if (line[0] == '+') {
+            shard.insert(username);
+        } else {
+            shard.erase(username);
+        }
+        journalEntries++;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < SHARDS; ++i) {
+        total += loaded[i]->size();
+        shards[i]->replace(std::move(loaded[i]));
+    }
+    count.store(total, std::memory_order_relaxed);
+
+    journalFd = ::open(journalPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (journalFd < 0) {
+        LOG_ERROR("Cannot open banlist journal: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    LOG_INFO("Banlist loaded: " + std::to_string(total) + " banned user(s), " +
+             std::to_string(journalEntries) + " journal entries");
+    if (journalEntries >= std::max(Constants::BANLIST_COMPACT_MIN_ENTRIES, total)) {
+        compactLocked();
+    }
+    return true;
+}
+
+bool Banlist::contains(const std::string& username) const {
+    Utils::RcuDomain::ReadGuard guard(rcu);
+    const Shard* shard = shards[shardOf(username)]->get(guard);
+    return shard->find(username) != shard->end();
+}
+
+bool Banlist::add(const std::string& username) {
+    return update(username, true);
+}
+
+bool Banlist::remove(const std::string& username) {
+    return update(username, false);
+}
+
+bool Banlist::update(const std::string& username, bool banned) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto& slot = *shards[shardOf(username)];
+    const Shard* current = slot.current();
+    if ((current->count(username) != 0) == banned) {
+        return false;  // Nothing to change
+    }
+
+    // Copy-on-write of a single shard; readers keep using the old copy meanwhile
+    auto next = std::make_unique<Shard>(*current);
+    if (banned) {
+        next->insert(username);
+        count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        next->erase(username);
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    slot.replace(std::move(next));
+
+    appendJournal(banned ? '+' : '-', username);
+    if (journalEntries >= std::max(Constants::BANLIST_COMPACT_MIN_ENTRIES, size())) {
+        compactLocked();
+    }
+    return true;
+}
+
+void Banlist::appendJournal(char op, const std::string& username) {
+    if (journalFd < 0) {
+        return;
+    }
+
+    std::string line;
+    line.reserve(username.size() + 2);
+    line.push_back(op);
+    line.append(username);
+    line.push_back('\n');
+
+    // O_APPEND: one write per entry, never a rewrite of the whole list
+    if (::write(journalFd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+        LOG_ERROR("Cannot append to banlist journal: " + std::string(std::strerror(errno)));
+        return;
+    }
+    journalEntries++;
+}
+
+bool Banlist::compact() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return compactLocked();
+}
+
+bool Banlist::compactLocked() {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR("Cannot open banlist file for writing");
+            return false;
+        }
+        for (const auto& shard : shards) {
+            for (const auto& username : *shard->current()) {
+                file << username << "\n";
+            }
+        }
+        if (!file.flush()) {
+            LOG_ERROR("Cannot write banlist snapshot");
+            return false;
+        }
+    }
+
+    int fd = ::open(temporary.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+
+    // Replaying the old journal over the new snapshot is harmless, so a crash
+    // between the rename and the truncation loses nothing
+    if (::rename(temporary.c_str(), path.c_str()) < 0) {
+        LOG_ERROR("Cannot replace banlist snapshot: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    if (journalFd >= 0 && ::ftruncate(journalFd, 0) < 0) {
+        LOG_ERROR("Cannot truncate banlist journal: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    LOG_DEBUGF("Banlist compacted: {} user(s), {} journal entries folded", size(), journalEntries);
+    journalEntries = 0;
+    return true;
+}
@@ -6,10 +6,65 @@
 #include "Utils/Constants.hpp"
 #include "Utils/NetworkStream.hpp"
 #include "Utils/MessageParser.hpp"
-#include <fstream>
+#include "Utils/RuntimeConfig.hpp"
+#include <algorithm>
+#include <fcntl.h>
 #include <sstream>
+#include <sys/stat.h>
 #include <unistd.h>
 
+namespace {
+
+/**
+ * @brief Reads up to `count` lines ending at offset `end`, seeking backward
+ *        block by block: the cost depends on the lines read, not the file size
+ * @return Offset of the first line read
+ */
+uint64_t readLinesBefore(int fd, uint64_t end, size_t count, std::vector<std::string>& lines) {
+    if (count == 0) {
+        return end;
+    }
+    std::vector<std::string> blocks;  // Newest first
+    uint64_t position = end;
+    size_t newlines = 0;
+    // count lines take count + 1 newlines: theirs and the one before the first
+    while (position > 0 && newlines <= count) {
+        size_t size = static_cast<size_t>(std::min<uint64_t>(Constants::BUFFER_SIZE, position));
+        std::string block(size, '\0');
+        if (::pread(fd, block.data(), size, static_cast<off_t>(position - size)) != static_cast<ssize_t>(size)) {
+            break;
+        }
+        position -= size;
+        newlines += static_cast<size_t>(std::count(block.begin(), block.end(), '\n'));
+        blocks.push_back(std::move(block));
+    }
+    
+    std::string text;
+    text.reserve(static_cast<size_t>(end - position));
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+        text += *it;
+    }
+    
+    size_t start = 0;
+    size_t found = 0;
+    size_t index = !text.empty() && text.back() == '\n' ? text.size() - 1 : text.size();
+    for (; index > 0 && count > 0; --index) {
+        if (text[index - 1] == '\n' && ++found == count) {
+            start = index;
+            break;
+        }
+    }
+    
+    std::istringstream stream(text.substr(start));
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+    return position + start;
+}
+
+} // namespace
+
 CommandHandler::CommandHandler(Server* server)
     : server(server) {
 }
@@ -45,19 +100,26 @@ void CommandHandler::handleConnect(const std::vector<std::string>& parsedData, i
     if (server->isBanned(username)) {
         LOG_WARNING("Banned user connection attempt: " + username);
         sendError(socket, "You are banned from this server");
-        close(socket);
+        server->closeClientSocket(socket);
         return;
     }
     
-    if (server->isUsernameTaken(username)) {
+    // One step: of two CONNECTs for the same name, exactly one registers
+    auto session = server->registerClient(username, socket);
+    if (!session) {
         LOG_WARNING("Username already taken: " + username);
         sendError(socket, "Username already exists");
         return;
     }
-      server->registerClient(username, socket);
     
-    LOG_CONNECT("New client: " + username);
+    LOG_CONNECTF("New client: {}", username);
     sendResponse(socket, Utils::MessageParser::build("OK", "Connected as " + username));
+    
+    // Messages received while the user was offline follow the OK reply
+    auto dispatcher = server->getDispatcher();
+    if (dispatcher) {
+        dispatcher->deliverStored(session);
+    }
 }
 
 void CommandHandler::handleDisconnect(const std::vector<std::string>& parsedData, int socket) {
@@ -71,8 +133,8 @@ void CommandHandler::handleDisconnect(const std::vector<std::string>& parsedData
     
     server->unregisterClient(username);
     
-    LOG_DISCONNECT("Client disconnected: " + username);
-    close(socket);
+    LOG_DISCONNECTF("Client disconnected: {}", username);
+    server->closeClientSocket(socket);
     
     if (Constants::AUTO_STOP_WHEN_NO_CLIENTS && server->getClientCount() == 0) {
         LOG_INFO("Last client disconnected - Stopping server");
@@ -88,17 +150,19 @@ void CommandHandler::handleSendMessage(const std::vector<std::string>& parsedDat
         return;
     }
     
-    std::string from = server->getUsernameBySocket(socket);
-    if (from.empty()) {
+    auto sender = server->getSessionBySocket(socket);
+    if (!sender) {
         LOG_WARNING("Message send attempt by unauthenticated client");
         sendError(socket, "Not authenticated");
         return;
     }
+    const std::string& from = sender->getUsername();
     
     server->incrementMessagesReceived();
     
     Message msg;
     msg.from = from;
+    msg.sender = sender;
     msg.to = Utils::sanitize(parsedData[1]);
     msg.subject = Utils::sanitize(parsedData[2]);
     msg.body = Utils::sanitize(parsedData[3]);
@@ -116,44 +180,163 @@ void CommandHandler::handleSendMessage(const std::vector<std::string>& parsedDat
         return;
     }
     
+    std::string optionError;
+    if (!parseSendOptions(parsedData, msg, optionError)) {
+        LOG_WARNING("Invalid SEND option from " + from + ": " + optionError);
+        sendError(socket, optionError);
+        return;
+    }
+    bool scheduled = msg.deliverAt.time_since_epoch().count() != 0;
+    
+    // Durable mode: the OK is only sent once the message is on stable storage
+    OfflineStore* store = server->getOfflineStore();
+    bool durable = store && RuntimeConfig::getInstance().read([](const ConfigSnapshot& config) { return config.durableSends; });
+    auto dispatcher = server->getDispatcher();
+    HistoryStore* history = server->getHistoryStore();
+    
     if (msg.to == "all") {
-        LOG_INFO("Broadcast from " + from);
-        auto clients = server->getAllClients();
+        LOG_INFOF("Broadcast from {}", from);
+        auto sessions = server->getAllSessions();
         
-        for (const auto& [username, userSocket] : clients) {
-            if (username != from) {
+        std::vector<Message> copies;
+        copies.reserve(sessions.size());
+        for (const auto& session : sessions) {
+            if (session != sender) {
                 Message broadcastMsg = msg;
-                broadcastMsg.to = username;
-                auto dispatcher = server->getDispatcher();
-                if (dispatcher) {
-                    dispatcher->queueMessage(broadcastMsg);
+                broadcastMsg.to = session->getUsername();
+                broadcastMsg.recipient = session;
+                broadcastMsg.priority = MessagePriority::BROADCAST;
+                if (durable) {
+                    broadcastMsg.storeSeq = store->append(broadcastMsg, true);
                 }
+                copies.push_back(std::move(broadcastMsg));
             }
         }
         
-        sendOK(socket, "Broadcast sent");
+        // One group commit covers every copy
+        if (durable && !store->sync()) {
+            for (const Message& copy : copies) {
+                store->acknowledge(copy.to, copy.storeSeq);
+            }
+            sendError(socket, "Failed to persist broadcast");
+            return;
+        }
+        
+        for (const Message& copy : copies) {
+            if (dispatcher && !dispatcher->queueMessage(copy) && copy.storeSeq != 0) {
+                store->acknowledge(copy.to, copy.storeSeq);
+            }
+        }
+        
+        if (history) {
+            history->record(from, msg);
+        }
+        sendOK(socket, scheduled ? "Broadcast scheduled" : "Broadcast sent");
         return;
     }
     
     // Error 2: Recipient user does not exist
-    int recipientSocket = server->getUserSocket(msg.to);
-    if (recipientSocket <= 0) {
+    msg.recipient = server->getSession(msg.to);
+    if (!msg.recipient && store && Utils::isValidUsername(msg.to) && !scheduled) {
+        std::string rejection;
+        if (store->append(msg, false, &rejection) != 0 && (!durable || store->sync())) {
+            LOG_INFOF("Recipient {} offline - message from {} stored", msg.to, from);
+            if (history) {
+                history->record(from, msg);
+            }
+            sendOK(socket, "Message stored for offline delivery");
+        } else if (!rejection.empty()) {
+            sendError(socket, "User '" + msg.to + "' is offline and the message cannot be stored: " + rejection);
+        } else {
+            sendError(socket, "Failed to store message for offline delivery");
+        }
+        return;
+    }
+    if (!msg.recipient && !(store && scheduled)) {
         LOG_WARNING("Non-existent recipient: " + msg.to + " (from " + from + ")");
         sendError(socket, "User '" + msg.to + "' does not exist or is offline");
         return;
     }
     
-    auto dispatcher = server->getDispatcher();
+    if (durable) {
+        msg.storeSeq = store->append(msg, true);
+        if (msg.storeSeq == 0 || !store->sync()) {
+            LOG_ERROR("Failed to persist message from " + from);
+            store->acknowledge(msg.to, msg.storeSeq);
+            sendError(socket, "Failed to send message: storage error");
+            return;
+        }
+    }
+    
     // Error 3: Sending could not be executed
     if (dispatcher && dispatcher->queueMessage(msg)) {
-        LOG_DEBUG("Message from " + from + " added to queue");
-        sendOK(socket, "Message sent");
+        LOG_DEBUGF("Message from {} added to queue", from);
+        if (history) {
+            history->record(from, msg);
+        }
+        sendOK(socket, scheduled ? "Message scheduled" : "Message sent");
     } else {
         LOG_ERROR("Failed to add message to queue");
+        if (msg.storeSeq != 0) {
+            store->acknowledge(msg.to, msg.storeSeq);
+        }
         sendError(socket, "Failed to send message: queue full or dispatcher error");
     }
 }
 
+bool CommandHandler::parseSendOptions(const std::vector<std::string>& parsedData, Message& msg, std::string& error) {
+    auto steadyNow = std::chrono::steady_clock::now();
+    
+    for (size_t i = 4; i < parsedData.size(); ++i) {
+        const std::string& option = parsedData[i];
+        size_t separator = option.find('=');
+        if (separator == std::string::npos) {
+            error = "Malformed option: " + option;
+            return false;
+        }
+        
+        std::string key = option.substr(0, separator);
+        long long value;
+        try {
+            value = std::stoll(option.substr(separator + 1));
+        } catch (...) {
+            error = "Invalid value for option " + key;
+            return false;
+        }
+        
+        if (key == "ttl") {
+            if (value <= 0 || value > Constants::MAX_MESSAGE_TTL_S) {
+                error = "ttl must be between 1 and " + std::to_string(Constants::MAX_MESSAGE_TTL_S) + " seconds";
+                return false;
+            }
+            msg.expiresAt = steadyNow + std::chrono::seconds(value);
+        } else if (key == "delay" || key == "at") {
+            long long delay = value;
+            if (key == "at") {
+                delay = value - std::chrono::duration_cast<std::chrono::seconds>(
+                    msg.timestamp.time_since_epoch()).count();
+            }
+            if (delay < 0 || delay > Constants::MAX_SCHEDULE_DELAY_S) {
+                error = "Delivery time must be within " + std::to_string(Constants::MAX_SCHEDULE_DELAY_S) + " seconds";
+                return false;
+            }
+            if (delay > 0) {
+                msg.deliverAt = steadyNow + std::chrono::seconds(delay);
+            }
+        } else {
+            error = "Unknown option: " + key;
+            return false;
+        }
+    }
+    
+    // The TTL counts from acceptance, so it must outlive the scheduled delivery
+    if (msg.expiresAt.time_since_epoch().count() != 0 && msg.deliverAt >= msg.expiresAt) {
+        error = "ttl expires before the scheduled delivery time";
+        return false;
+    }
+    return true;
+}
+
 void CommandHandler::handlePing(const std::vector<std::string>& parsedData, int socket) {
     (void)parsedData;
     sendResponse(socket, "PONG\n");
@@ -162,14 +345,8 @@ void CommandHandler::handlePing(const std::vector<std::string>& parsedData, int
 
 void CommandHandler::handlePong(const std::vector<std::string>& parsedData, int socket) {
     (void)parsedData;
-    std::string username = server->getUsernameBySocket(socket);
-    
-    if (username.empty()) {
-        return;
-    }
-    
-    server->updateClientPong(username);
-    LOG_DEBUG("PONG received from " + username);
+    // The reader already recorded the frame; this covers direct executeCommand() calls
+    server->touchClient(socket);
 }
 
 void CommandHandler::handleListUsers(const std::vector<std::string>& parsedData, int socket) {
@@ -190,34 +367,163 @@ void CommandHandler::handleListUsers(const std::vector<std::string>& parsedData,
 }
 
 void CommandHandler::handleGetLog(const std::vector<std::string>& parsedData, int socket) {
-    (void)parsedData;
-    
-    std::ifstream logFile(Constants::DEFAULT_SERVER_LOG);
-    if (!logFile.is_open()) {
-        LOG_WARNING("Cannot open log file: " + Constants::DEFAULT_SERVER_LOG);
-        sendError(socket, "Log file not available");
-        return;
-    }
+    const std::string cursor = parsedData.size() > 1 ? parsedData[1] : "";
+    const size_t pageLines = Constants::LOG_PAGE_LINES;
     
     std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(logFile, line)) {
-        lines.push_back(line);
+    std::string older;
+    const std::string& binaryLogPath = Logger::getInstance().getBinaryLogPath();
+    if (!binaryLogPath.empty()) {
+        // Records decoded to the text layout; cursor: sequence number
+        Utils::BinaryLogReader reader;
+        std::string error;
+        if (!reader.open(binaryLogPath, error)) {
+            LOG_WARNING("Cannot read binary log: " + error);
+            sendError(socket, "Log file not available");
+            return;
+        }
+        uint64_t first = reader.firstSequence();
+        uint64_t end = reader.endSequence();
+        try {
+            end = cursor.empty() ? end : std::min<uint64_t>(end, std::stoull(cursor));
+        } catch (...) {
+            sendError(socket, "Invalid GET_LOG cursor");
+            return;
+        }
+        uint64_t start = end > first + pageLines ? end - pageLines : first;
+        std::string line;
+        for (uint64_t sequence = start; sequence < end; ++sequence) {
+            if (reader.line(sequence, line)) {
+                lines.push_back(line);
+            }
+        }
+        older = start > first ? std::to_string(start) : "";
+    } else {
+        // Cursor: <segment>:<offset>, an empty offset standing for the end of the segment
+        Logger& logger = Logger::getInstance();
+        uint64_t segment = logger.getLogSegment();
+        uint64_t end = UINT64_MAX;
+        try {
+            size_t colon = cursor.find(':');
+            if (colon != std::string::npos) {
+                segment = std::stoull(cursor.substr(0, colon));
+                end = colon + 1 < cursor.size() ? std::stoull(cursor.substr(colon + 1)) : UINT64_MAX;
+            } else if (!cursor.empty()) {
+                throw std::invalid_argument(cursor);
+            }
+        } catch (...) {
+            sendError(socket, "Invalid GET_LOG cursor");
+            return;
+        }
+        
+        bool opened = false;
+        while (true) {
+            std::string path = logger.getSegmentPath(segment);
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                older.clear();  // Rotated away
+                break;
+            }
+            opened = true;
+            struct stat info{};
+            if (::fstat(fd, &info) == 0) {
+                end = std::min<uint64_t>(end, static_cast<uint64_t>(info.st_size));
+            }
+            std::vector<std::string> page;
+            uint64_t start = readLinesBefore(fd, end, pageLines - lines.size(), page);
+            ::close(fd);
+            lines.insert(lines.begin(), page.begin(), page.end());
+            
+            if (start > 0) {
+                older = std::to_string(segment) + ":" + std::to_string(start);
+                break;
+            }
+            if (segment <= 1) {
+                older.clear();
+                break;
+            }
+            --segment;
+            end = UINT64_MAX;
+            older = std::to_string(segment) + ":";
+            if (lines.size() >= pageLines) {
+                if (::access(logger.getSegmentPath(segment).c_str(), F_OK) != 0) {
+                    older.clear();
+                }
+                break;
+            }
+        }
+        if (!opened) {
+            LOG_WARNING("Cannot open log file: " + logger.getSegmentPath(segment));
+            sendError(socket, "Log file not available");
+            return;
+        }
     }
-    logFile.close();
     
     if (lines.empty()) {
-        sendResponse(socket, Utils::MessageParser::build("LOG", "Log file is empty"));
+        sendResponse(socket, Utils::MessageParser::build("LOG", "Log file is empty", older));
         LOG_DEBUG("Empty log sent");
         return;
     }
     
-    size_t start = lines.size() > 50 ? lines.size() - 50 : 0;
     std::string logContent;
-    for (size_t i = start; i < lines.size(); ++i) {
-        logContent += lines[i] + "\n";
+    for (const std::string& line : lines) {
+        logContent += line + "\n";
+    }
+    
+    sendResponse(socket, Utils::MessageParser::build("LOG", logContent, older));
+    LOG_DEBUGF("Log sent ({} lines)", lines.size());
+}
+
+void CommandHandler::handleHistory(const std::vector<std::string>& parsedData, int socket) {
+    auto session = server->getSessionBySocket(socket);
+    if (!session) {
+        sendError(socket, "Not authenticated");
+        return;
+    }
+    
+    HistoryStore* history = server->getHistoryStore();
+    if (!history) {
+        sendError(socket, "History is disabled on this server");
+        return;
+    }
+    
+    const std::string mode = parsedData.size() > 1 ? parsedData[1] : "seq";
+    HistoryPage page;
+    try {
+        if (mode == "seq") {
+            uint64_t start = parsedData.size() > 2 ? std::stoull(parsedData[2]) : 0;
+            int count = parsedData.size() > 3 ? std::stoi(parsedData[3]) : Constants::HISTORY_PAGE_SIZE;
+            count = std::clamp(count, 1, Constants::HISTORY_PAGE_MAX);
+            page = history->bySequence(session->getUsername(), start, static_cast<size_t>(count));
+        } else if (mode == "time" && parsedData.size() > 3) {
+            int64_t from = std::stoll(parsedData[2]);
+            int64_t to = std::stoll(parsedData[3]);
+            int count = parsedData.size() > 4 ? std::stoi(parsedData[4]) : Constants::HISTORY_PAGE_SIZE;
+            uint64_t cursor = parsedData.size() > 5 ? std::stoull(parsedData[5]) : 0;
+            count = std::clamp(count, 1, Constants::HISTORY_PAGE_MAX);
+            page = history->byTime(session->getUsername(), from, to, static_cast<size_t>(count), cursor);
+        } else {
+            sendError(socket, "Usage: HISTORY;seq;<start>;<count> or HISTORY;time;<from>;<to>;<count>[;<cursor>]");
+            return;
+        }
+    } catch (...) {
+        sendError(socket, "Invalid HISTORY arguments");
+        return;
     }
     
-    sendResponse(socket, Utils::MessageParser::build("LOG", logContent));
-    LOG_DEBUG("Log sent (" + std::to_string(lines.size() - start) + " lines)");
+    // Through the session so the frames never interleave with dispatcher deliveries
+    for (const HistoryEntry& entry : page.entries) {
+        (void)session->send(Utils::MessageParser::build(
+            "HISTORY",
+            std::to_string(entry.seq),
+            entry.from,
+            entry.to,
+            entry.subject,
+            entry.body,
+            std::to_string(entry.timestamp)
+        ));
+    }
+    (void)session->send(Utils::MessageParser::build(
+        "HISTORY_END", std::to_string(page.nextSeq), std::to_string(page.entries.size())));
+    LOG_DEBUGF("History sent to {} ({} messages)", session->getUsername(), page.entries.size());
 }
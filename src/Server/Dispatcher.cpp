@@ -1,97 +1,478 @@
 #include "Server/Dispatcher.hpp"
 #include "Server/Server.hpp"
+#include "Server/Session.hpp"
 #include "Utils/Logger.hpp"
 #include "Utils/Constants.hpp"
-#include "Utils/NetworkStream.hpp"
 #include "Utils/MessageParser.hpp"
 #include "Utils/Utils.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <algorithm>
 #include <thread>
 
-Dispatcher::Dispatcher(Server* attributedServer) : attributedServer(attributedServer) {
+namespace {
+// Marks a pendingAcks entry that must go back to pending instead of being retired
+constexpr uint64_t RELEASE_FLAG = uint64_t{1} << 63;
+}
+
+Dispatcher::Dispatcher(Server* attributedServer)
+    : timers(std::chrono::milliseconds(Constants::TIMER_WHEEL_TICK_MS))
+    , attributedServer(attributedServer) {
     config.startedTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()
     );
+    auto& runtime = RuntimeConfig::getInstance();
+    loadLimits(runtime.current());
+    configSubscription = runtime.subscribe([this](const ConfigSnapshot& settings) { loadLimits(settings); });
     LOG_INFO("Dispatcher created");
 }
 
+Dispatcher::~Dispatcher() {
+    RuntimeConfig::getInstance().unsubscribe(configSubscription);
+}
+
+const char* Dispatcher::priorityName(MessagePriority priority) {
+    switch (priority) {
+        case MessagePriority::ADMIN:     return "admin";
+        case MessagePriority::DIRECT:    return "direct";
+        case MessagePriority::BROADCAST: return "broadcast";
+        default:                         return "unknown";
+    }
+}
+
+void Dispatcher::loadLimits(const ConfigSnapshot& settings) {
+    std::lock_guard<std::mutex> lock(messagesMutex);
+    config.maxStoredMessages = settings.maxQueueSize;
+    config.maxQueuedBytes = static_cast<size_t>(settings.maxQueueKb) * 1024;
+    config.maxQueuedBytesPerRecipient = static_cast<size_t>(settings.maxQueueKbPerUser) * 1024;
+}
+
 bool Dispatcher::queueMessage(const Message& msg) {
     std::lock_guard<std::mutex> lock(messagesMutex);
     
-    if (messages.size() >= static_cast<size_t>(config.maxStoredMessages)) {
+    // Future delivery: park the message in the timer wheel
+    if (msg.deliverAt > std::chrono::steady_clock::now()) {
+        size_t size = msg.queuedSize();
+        if (queuedBytes + scheduledBytes + size > config.maxQueuedBytes) {
+            classes[static_cast<size_t>(msg.priority)].stats.dropped++;
+            LOG_WARNING("Queue full (byte budget) - scheduled message rejected");
+            return false;
+        }
+        
+        timers.schedule(msg.deliverAt, TimerTask{nullptr, std::make_unique<Message>(msg)});
+        scheduledCount++;
+        scheduledBytes += size;
+        timersChanged = true;
+        cv.notify_one();  // The next wake-up time may have changed
+        return true;
+    }
+    
+    return enqueueLocked(msg);
+}
+
+bool Dispatcher::enqueueLocked(const Message& msg) {
+    PriorityClass& cls = classes[static_cast<size_t>(msg.priority)];
+    size_t size = msg.queuedSize();
+    
+    // A message that can never fit is rejected whatever the policy
+    if (size > config.maxQueuedBytes || size > config.maxQueuedBytesPerRecipient) {
+        cls.stats.dropped++;
+        LOG_WARNING("Message from " + msg.from + " exceeds the queue budget (" + std::to_string(size) + " bytes)");
+        return false;
+    }
+    
+    while (true) {
+        auto recipientIt = recipientBytes.find(msg.to);
+        size_t recipientQueued = recipientIt != recipientBytes.end() ? recipientIt->second : 0;
+        
+        bool countFull = totalQueued >= static_cast<size_t>(config.maxStoredMessages);
+        bool bytesFull = queuedBytes + scheduledBytes + size > config.maxQueuedBytes;
+        bool recipientFull = recipientQueued + size > config.maxQueuedBytesPerRecipient;
+        
+        if (!countFull && !bytesFull && !recipientFull) {
+            break;
+        }
+        
+        const char* reason = recipientFull ? "recipient budget" : (bytesFull ? "byte budget" : "message limit");
+        
         switch (config.queuePolicy) {
             case QueueFullPolicy::REJECT:
-                LOG_WARNING("Queue full - message rejected (policy: REJECT)");
+                cls.stats.dropped++;
+                LOG_WARNING(std::string("Queue full (") + reason + ") - message rejected (policy: REJECT)");
                 return false;
                 
             case QueueFullPolicy::DROP_OLDEST:
-                messages.pop(); 
-                LOG_WARNING("Queue full - oldest message dropped (policy: DROP_OLDEST)");
+                if (!evictOldest(msg, recipientFull && !countFull && !bytesFull)) {
+                    cls.stats.dropped++;
+                    return false;
+                }
+                LOG_WARNING(std::string("Queue full (") + reason + ") - oldest message dropped (policy: DROP_OLDEST)");
                 break;
                 
             case QueueFullPolicy::DROP_NEWEST:
-                LOG_WARNING("Queue full - new message ignored (policy: DROP_NEWEST)");
+                cls.stats.dropped++;
+                LOG_WARNING(std::string("Queue full (") + reason + ") - new message ignored (policy: DROP_NEWEST)");
                 return false;  // Ignore the new message
         }
     }
     
-    messages.push(msg);
+    auto [it, inserted] = cls.mailboxes.try_emplace(msg.to);
+    if (inserted) {
+        cls.activeOrder.push_back(msg.to);
+    }
+    
+    QueuedMessage& queued = it->second.messages.emplace_back();
+    queued.msg = msg;
+    queued.msg.queuedAt = std::chrono::steady_clock::now();
+    
+    // Deque entries keep their address until popped, so the timer can point at them
+    if (msg.expiresAt.time_since_epoch().count() != 0) {
+        queued.expiryTimer = timers.schedule(msg.expiresAt, TimerTask{&queued, nullptr});
+    }
+    
+    cls.depth++;
+    cls.bytes += size;
+    cls.stats.enqueued++;
+    totalQueued++;
+    queuedBytes += size;
+    recipientBytes[msg.to] += size;
     cv.notify_one();  // Wake up dispatcher thread
     return true;
 }
 
+bool Dispatcher::evictOldest(const Message& incoming, bool recipientOnly) {
+    // Prefer evicting from the recipient's own mailboxes, lowest class first,
+    // then (global overflow only) from the lowest priority class still holding messages
+    PriorityClass* victimClass = nullptr;
+    Mailbox* victim = nullptr;
+    size_t incomingClass = static_cast<size_t>(incoming.priority);
+    
+    for (size_t i = MESSAGE_PRIORITY_COUNT; i-- > incomingClass && !victim;) {
+        auto it = classes[i].mailboxes.find(incoming.to);
+        if (it != classes[i].mailboxes.end()) {
+            purgeExpired(it->second);
+            if (!it->second.messages.empty()) {
+                victimClass = &classes[i];
+                victim = &it->second;
+            }
+        }
+    }
+    
+    for (size_t i = MESSAGE_PRIORITY_COUNT; i-- > incomingClass && !victim && !recipientOnly;) {
+        PriorityClass& cls = classes[i];
+        for (const std::string& name : cls.activeOrder) {
+            Mailbox& mailbox = cls.mailboxes[name];
+            purgeExpired(mailbox);
+            if (!mailbox.messages.empty()) {
+                victimClass = &cls;
+                victim = &mailbox;
+                break;
+            }
+        }
+    }
+    
+    // Never evict higher priority traffic to make room
+    if (!victim) {
+        LOG_WARNING("Queue full - no lower priority message to drop");
+        return false;
+    }
+    
+    // Empty mailboxes stay in the round-robin order; popNext() removes them
+    QueuedMessage& oldest = victim->messages.front();
+    if (oldest.expiryTimer != 0) {
+        timers.cancel(oldest.expiryTimer);
+    }
+    if (oldest.msg.storeSeq != 0) {
+        pendingAcks.emplace_back(oldest.msg.to, oldest.msg.storeSeq | RELEASE_FLAG);
+    }
+    releaseBytes(*victimClass, oldest.msg);
+    victim->messages.pop_front();
+    
+    victimClass->depth--;
+    victimClass->stats.dropped++;
+    totalQueued--;
+    return true;
+}
+
+void Dispatcher::releaseBytes(PriorityClass& cls, const Message& msg) {
+    size_t size = msg.queuedSize();
+    cls.bytes -= size;
+    queuedBytes -= size;
+    
+    auto it = recipientBytes.find(msg.to);
+    if (it != recipientBytes.end()) {
+        it->second -= size;
+        if (it->second == 0) {
+            recipientBytes.erase(it);
+        }
+    }
+}
+
+void Dispatcher::purgeExpired(Mailbox& mailbox) {
+    while (!mailbox.messages.empty() && mailbox.messages.front().expired) {
+        mailbox.messages.pop_front();
+    }
+}
+
+void Dispatcher::onTimer(TimerTask&& task) {
+    if (task.scheduled) {
+        Message& msg = *task.scheduled;
+        scheduledCount--;
+        scheduledBytes -= msg.queuedSize();
+        
+        // The recipient may have reconnected since the message was scheduled
+        if (!msg.recipient || !msg.recipient->isActive()) {
+            msg.recipient = attributedServer->getSession(msg.to);
+        }
+        
+        if (!enqueueLocked(msg)) {
+            notifySender(msg, "queue full");
+        }
+        return;
+    }
+    
+    // TTL elapsed: account for the message now, skip its entry later
+    QueuedMessage& entry = *task.expiring;
+    PriorityClass& cls = classes[static_cast<size_t>(entry.msg.priority)];
+    
+    entry.expired = true;
+    entry.expiryTimer = 0;
+    releaseBytes(cls, entry.msg);
+    cls.depth--;
+    cls.stats.expired++;
+    totalQueued--;
+    
+    LOG_DEBUGF("Message from {} to {} expired", entry.msg.from, entry.msg.to);
+    notifySender(entry.msg, "expired before delivery");
+    if (entry.msg.storeSeq != 0) {
+        pendingAcks.emplace_back(entry.msg.to, entry.msg.storeSeq);
+    }
+    
+    // Free the payload right away; the empty shell is popped when reached
+    entry.msg.subject.clear();
+    entry.msg.subject.shrink_to_fit();
+    entry.msg.body.clear();
+    entry.msg.body.shrink_to_fit();
+    entry.msg.sender.reset();
+    entry.msg.recipient.reset();
+    
+    auto it = cls.mailboxes.find(entry.msg.to);
+    if (it != cls.mailboxes.end()) {
+        purgeExpired(it->second);
+    }
+}
+
+size_t Dispatcher::deliverStored(const std::shared_ptr<Session>& session) {
+    OfflineStore* store = attributedServer->getOfflineStore();
+    if (!store) {
+        return 0;
+    }
+    
+    size_t queued = 0;
+    for (Message& msg : store->takePending(session->getUsername())) {
+        msg.recipient = session;
+        if (queueMessage(msg)) {
+            queued++;
+        } else {
+            store->release(msg.to, msg.storeSeq);
+        }
+    }
+    
+    if (queued > 0) {
+        LOG_INFOF("Queued {} stored message(s) for {}", queued, session->getUsername());
+    }
+    return queued;
+}
+
+void Dispatcher::handleUndelivered(const Message& msg) {
+    OfflineStore* store = attributedServer->getOfflineStore();
+    
+    // Already in the store: make it pending again for the next connection
+    if (store && msg.storeSeq != 0) {
+        store->release(msg.to, msg.storeSeq);
+        return;
+    }
+    
+    std::string rejection;
+    if (store && store->append(msg, false, &rejection) != 0) {
+        LOG_INFOF("Recipient {} offline - message from {} stored", msg.to, msg.from);
+        return;
+    }
+    
+    // Error 6: Recipient just disconnected
+    LOG_WARNING("Recipient not found or disconnected: " + msg.to + " (message from " + msg.from + ")");
+    
+    // Notify sender that message could not be delivered (admin messages have no sender session)
+    if (msg.sender) {
+        std::string errorMsg = Utils::MessageParser::build(
+            "ERROR", 
+            "Message to '" + msg.to + "' could not be delivered: user disconnected" +
+                (rejection.empty() ? "" : " and " + rejection)
+        );
+        (void)msg.sender->send(errorMsg);
+    }
+}
+
+void Dispatcher::notifySender(const Message& msg, const std::string& reason) {
+    // Sent by run() once messagesMutex is released
+    if (msg.sender) {
+        pendingNotices.emplace_back(msg.sender, Utils::MessageParser::build(
+            "ERROR", "Message to '" + msg.to + "' could not be delivered: " + reason));
+    }
+}
+
+bool Dispatcher::popNext(Message& out) {
+    for (PriorityClass& cls : classes) {
+        while (!cls.activeOrder.empty()) {
+            const std::string& name = cls.activeOrder.front();
+            auto it = cls.mailboxes.find(name);
+            Mailbox& mailbox = it->second;
+            
+            purgeExpired(mailbox);
+            if (mailbox.messages.empty()) {
+                cls.mailboxes.erase(it);
+                cls.activeOrder.pop_front();
+                continue;
+            }
+            
+            QueuedMessage& next = mailbox.messages.front();
+            size_t cost = std::max<size_t>(next.msg.payloadSize(), 1);
+            
+            // Not enough credit: grant a quantum and move to the back of the round
+            if (mailbox.deficit < cost) {
+                mailbox.deficit += config.mailboxQuantum;
+                cls.activeOrder.push_back(name);
+                cls.activeOrder.pop_front();
+                continue;
+            }
+            
+            mailbox.deficit -= cost;
+            if (next.expiryTimer != 0) {
+                timers.cancel(next.expiryTimer);
+            }
+            releaseBytes(cls, next.msg);
+            out = std::move(next.msg);
+            mailbox.messages.pop_front();
+            
+            purgeExpired(mailbox);
+            if (mailbox.messages.empty()) {
+                cls.mailboxes.erase(it);
+                cls.activeOrder.pop_front();
+            }
+            
+            cls.depth--;
+            totalQueued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Dispatcher::recordDelivery(const Message& msg) {
+    double latencyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - msg.queuedAt
+    ).count();
+    
+    std::lock_guard<std::mutex> lock(messagesMutex);
+    PriorityClass& cls = classes[static_cast<size_t>(msg.priority)];
+    cls.stats.delivered++;
+    cls.totalLatencyMs += latencyMs;
+    cls.stats.maxLatencyMs = std::max(cls.stats.maxLatencyMs, latencyMs);
+}
+
+DispatcherStats Dispatcher::getStats() {
+    std::lock_guard<std::mutex> lock(messagesMutex);
+    DispatcherStats result;
+    
+    for (size_t i = 0; i < MESSAGE_PRIORITY_COUNT; ++i) {
+        const PriorityClass& cls = classes[i];
+        DispatcherClassStats& stats = result.classes[i];
+        stats = cls.stats;
+        stats.depth = cls.depth;
+        stats.mailboxes = cls.mailboxes.size();
+        stats.bytes = cls.bytes;
+        stats.avgLatencyMs = cls.stats.delivered > 0 ? cls.totalLatencyMs / cls.stats.delivered : 0.0;
+    }
+    
+    result.totalQueued = totalQueued;
+    result.queuedBytes = queuedBytes + scheduledBytes;
+    result.maxQueuedBytes = config.maxQueuedBytes;
+    result.maxQueuedBytesPerRecipient = config.maxQueuedBytesPerRecipient;
+    result.scheduled = scheduledCount;
+    result.pendingTimers = timers.size();
+    return result;
+}
+
 void Dispatcher::run() {
     LOG_INFO("Dispatcher started");
     
+    auto shouldWake = [this] {
+        return (!suspended && (totalQueued > 0 || timersChanged)) ||
+               !running || attributedServer->getStatus() != SERVER_STATUS::RUNNING;
+    };
+    
     while (running && attributedServer->getStatus() == SERVER_STATUS::RUNNING) {
         std::unique_lock<std::mutex> lock(messagesMutex);
         
-        // Wait for a message to arrive or for the dispatcher to stop
-        cv.wait(lock, [this] { 
-            return !messages.empty() || !running || attributedServer->getStatus() != SERVER_STATUS::RUNNING;
-        });
+        // Wait for a message, the next timer, or for the dispatcher to stop
+        auto nextTimer = timers.nextExpiry();
+        if (suspended) {
+            cv.wait(lock, shouldWake);
+            continue;
+        } else if (nextTimer) {
+            cv.wait_until(lock, *nextTimer, shouldWake);
+        } else {
+            cv.wait(lock, shouldWake);
+        }
+        timersChanged = false;
         
         // Check if we should stop
         if (!running || attributedServer->getStatus() != SERVER_STATUS::RUNNING) {
             break;
         }
-        
-        // Check if there's a message (could be false if woken up by stop)
-        if (messages.empty()) {
-            continue;
+        if (suspended) {
+            continue;  // A timer deadline passed while suspended
         }
         
-        Message msg = messages.front();
-        messages.pop();
+        timers.advance(std::chrono::steady_clock::now(), [this](TimerTask&& task) {
+            onTimer(std::move(task));
+        });
+        auto notices = std::move(pendingNotices);
+        auto acks = std::move(pendingAcks);
+        pendingNotices.clear();
+        pendingAcks.clear();
+        
+        // Check if there's a message (could be false if woken up by a timer or stop)
+        Message msg;
+        bool hasMessage = popNext(msg);
         
+        std::unique_lock<std::mutex> delivery(deliveryMutex);
         lock.unlock();  // Release mutex during processing
         
-        // Delay between messages if configured
-        if (config.delayBetweenMessages > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.delayBetweenMessages));
+        for (auto& [session, notice] : notices) {
+            (void)session->send(notice);
         }
         
-        int recipientSocket = attributedServer->getUserSocket(msg.to);
-        
-        // Error 6: Recipient just disconnected
-        if (recipientSocket <= 0) {
-            LOG_WARNING("Recipient not found or disconnected: " + msg.to + " (message from " + msg.from + ")");
-            
-            // Notify sender that message could not be delivered
-            int senderSocket = attributedServer->getUserSocket(msg.from);
-            if (senderSocket > 0) {
-                Network::NetworkStream senderStream(senderSocket);
-                std::string errorMsg = Utils::MessageParser::build(
-                    "ERROR", 
-                    "Message to '" + msg.to + "' could not be delivered: user disconnected"
-                );
-                (void)senderStream.send(errorMsg);
+        // Stored messages that expired or were evicted from the queue
+        if (OfflineStore* store = attributedServer->getOfflineStore()) {
+            for (const auto& [username, seq] : acks) {
+                if (seq & RELEASE_FLAG) {
+                    store->release(username, seq & ~RELEASE_FLAG);
+                } else {
+                    store->acknowledge(username, seq);
+                }
             }
+        }
+        
+        if (!hasMessage) {
             continue;
         }
         
-        std::string timestampStr = Utils::timestampToUnixString(msg.timestamp);
+        // Delay between messages if configured
+        if (config.delayBetweenMessages > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.delayBetweenMessages));
+        }
         
-        Network::NetworkStream stream(recipientSocket);
+        std::string timestampStr = Utils::timestampToUnixString(msg.timestamp);
         std::string formattedMessage = Utils::MessageParser::build(
             "MESSAGE", 
             msg.from, 
@@ -100,14 +481,29 @@ void Dispatcher::run() {
             timestampStr
         );
         
-        if (stream.send(formattedMessage)) {
+        // The session was resolved at enqueue time: no registry lookup here
+        if (msg.recipient && msg.recipient->send(formattedMessage)) {
             attributedServer->incrementMessagesSent();
-            LOG_DEBUG("Message dispatched from " + msg.from + " to " + msg.to);
-        } else {
+            recordDelivery(msg);
+            if (msg.storeSeq != 0 && attributedServer->getOfflineStore()) {
+                attributedServer->getOfflineStore()->acknowledge(msg.to, msg.storeSeq);
+            }
+            recordHistory(msg);
+            LOG_DEBUGF("Message dispatched from {} to {}", msg.from, msg.to);
+            continue;
+        }
+        
+        if (msg.recipient && msg.recipient->isActive()) {
             LOG_ERROR("Failed to send message to " + msg.to);
+            if (msg.storeSeq != 0 && attributedServer->getOfflineStore()) {
+                attributedServer->getOfflineStore()->release(msg.to, msg.storeSeq);
+            }
+            continue;
         }
+        
+        handleUndelivered(msg);
     }
-      LOG_INFO("Dispatcher stopped");
+    LOG_INFO("Dispatcher stopped");
 }
 
 void Dispatcher::stop() {
@@ -117,4 +513,125 @@ void Dispatcher::stop() {
     }
     cv.notify_all();  // Wake up thread so it can terminate
     LOG_INFO("Dispatcher stop requested");
-}
\ No newline at end of file
+}
+
+void Dispatcher::suspend() {
+    {
+        std::lock_guard<std::mutex> lock(messagesMutex);
+        suspended = true;
+    }
+    // run() takes deliveryMutex before releasing messagesMutex, so once we get
+    // it no message is in flight and none can be popped
+    std::lock_guard<std::mutex> delivery(deliveryMutex);
+    
+    // History writes of delivered messages complete before the files change hands
+    std::unique_lock<std::mutex> lock(historyMutex);
+    historyCv.wait(lock, [this] { return pendingHistory == 0; });
+    LOG_INFO("Dispatcher suspended");
+}
+
+void Dispatcher::recordHistory(const Message& msg) {
+    HistoryStore* history = attributedServer->getHistoryStore();
+    if (!history) {
+        return;
+    }
+    
+    // With a reader thread per connection every worker may be pinned by a client
+    WorkStealingPool* pool = attributedServer->getThreadPool();
+    if (!pool || !attributedServer->usesEventLoop()) {
+        history->record(msg.to, msg);
+        return;
+    }
+    
+    // Off the delivery path: the disk write no longer delays the next message
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        pendingHistory++;
+    }
+    pool->enqueue([this, history, msg]() {
+        history->record(msg.to, msg);
+        {
+            std::lock_guard<std::mutex> lock(historyMutex);
+            pendingHistory--;
+        }
+        historyCv.notify_all();
+    });
+}
+
+void Dispatcher::resume() {
+    {
+        std::lock_guard<std::mutex> lock(messagesMutex);
+        suspended = false;
+        timersChanged = true;
+    }
+    cv.notify_all();
+    LOG_INFO("Dispatcher resumed");
+}
+
+size_t Dispatcher::spill(OfflineStore& store) {
+    std::vector<Message> messages;
+    std::vector<std::pair<std::shared_ptr<Session>, std::string>> notices;
+    std::vector<std::pair<std::string, uint64_t>> acks;
+    
+    {
+        std::lock_guard<std::mutex> lock(messagesMutex);
+        messages.reserve(totalQueued + scheduledCount);
+        
+        for (PriorityClass& cls : classes) {
+            for (auto& [name, mailbox] : cls.mailboxes) {
+                for (QueuedMessage& queued : mailbox.messages) {
+                    if (!queued.expired) {
+                        messages.push_back(std::move(queued.msg));
+                    }
+                }
+            }
+            cls.mailboxes.clear();
+            cls.activeOrder.clear();
+            cls.depth = 0;
+            cls.bytes = 0;
+        }
+        totalQueued = 0;
+        queuedBytes = 0;
+        recipientBytes.clear();
+        
+        // TTL timers point at the entries just cleared; scheduled ones carry a message
+        timers.drain([&messages](TimerTask&& task) {
+            if (task.scheduled) {
+                messages.push_back(std::move(*task.scheduled));
+            }
+        });
+        scheduledCount = 0;
+        scheduledBytes = 0;
+        
+        notices = std::move(pendingNotices);
+        acks = std::move(pendingAcks);
+        pendingNotices.clear();
+        pendingAcks.clear();
+    }
+    
+    for (auto& [session, notice] : notices) {
+        (void)session->send(notice);
+    }
+    for (const auto& [username, seq] : acks) {
+        if (seq & RELEASE_FLAG) {
+            store.release(username, seq & ~RELEASE_FLAG);
+        } else {
+            store.acknowledge(username, seq);
+        }
+    }
+    
+    size_t spilled = 0;
+    for (const Message& msg : messages) {
+        if (msg.storeSeq != 0) {
+            store.release(msg.to, msg.storeSeq);
+            spilled++;
+        } else if (store.append(msg) != 0) {
+            spilled++;
+        } else {
+            LOG_ERROR("Cannot store queued message from " + msg.from + " to " + msg.to);
+        }
+    }
+    
+    LOG_INFO("Dispatcher spilled " + std::to_string(spilled) + " message(s) to the offline store");
+    return spilled;
+}
@@ -0,0 +1,174 @@
+#include "Server/EventLoop.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/Logger.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+EventLoop::~EventLoop() {
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+    for (auto& chunk : buffers) {
+        delete chunk.load(std::memory_order_relaxed);
+    }
+}
+
+bool EventLoop::open(int wakeup) {
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        LOG_ERROR("Cannot create epoll instance: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    wakeupFd = wakeup;
+    if (wakeupFd >= 0) {
+        // Level-triggered: stays reported until its owner drains it
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeupFd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event) < 0) {
+            LOG_ERROR("Cannot watch wakeup descriptor: " + std::string(std::strerror(errno)));
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string* EventLoop::buffer(int socket, bool create) {
+    if (socket < 0 || static_cast<size_t>(socket) >= BUFFER_CHUNK * BUFFER_CHUNKS) {
+        return nullptr;
+    }
+    auto& chunkPtr = buffers[static_cast<size_t>(socket) / BUFFER_CHUNK];
+    BufferChunk* chunk = chunkPtr.load(std::memory_order_acquire);
+    if (!chunk && create) {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        chunk = chunkPtr.load(std::memory_order_acquire);
+        if (!chunk) {
+            chunk = new BufferChunk();
+            chunkPtr.store(chunk, std::memory_order_release);
+        }
+    }
+    return chunk ? &(*chunk)[static_cast<size_t>(socket) % BUFFER_CHUNK] : nullptr;
+}
+
+const std::string* EventLoop::buffer(int socket) const {
+    return const_cast<EventLoop*>(this)->buffer(socket, false);
+}
+
+bool EventLoop::add(int socket) {
+    std::string* pending = buffer(socket, true);
+    if (!pending) {
+        LOG_ERROR("Socket number too large for the event loop: " + std::to_string(socket));
+        return false;
+    }
+    std::string().swap(*pending);
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = socket;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) < 0) {
+        LOG_ERROR("Cannot watch socket " + std::to_string(socket) + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::rearm(int socket) {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = socket;
+    return ::epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event) == 0;
+}
+
+bool EventLoop::wait(std::vector<int>& ready) {
+    epoll_event events[Constants::EVENT_LOOP_MAX_EVENTS];
+    ready.clear();
+
+    int count = ::epoll_wait(epollFd, events, Constants::EVENT_LOOP_MAX_EVENTS, -1);
+    if (count < 0) {
+        if (errno != EINTR) {
+            LOG_ERROR("epoll_wait failed: " + std::string(std::strerror(errno)));
+        }
+        return false;
+    }
+
+    bool woken = false;
+    for (int i = 0; i < count; ++i) {
+        if (events[i].data.fd == wakeupFd) {
+            woken = true;
+        } else {
+            ready.push_back(events[i].data.fd);
+        }
+    }
+    return woken;
+}
+
+EventLoop::ReadStatus EventLoop::read(int socket, std::vector<std::string>& frames) {
+    std::string* pending = buffer(socket, false);
+    if (!pending) {
+        return ReadStatus::GONE;
+    }
+
+    // Bounded per call so one busy client cannot hold its worker forever;
+    // the socket is reported again at rearm() if bytes remain
+    char chunk[Constants::BUFFER_SIZE];
+    size_t budget = Constants::EVENT_LOOP_READ_BUDGET;
+    ReadStatus status = ReadStatus::OPEN;
+    while (budget > 0) {
+        ssize_t received = ::recv(socket, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (received > 0) {
+            pending->append(chunk, static_cast<size_t>(received));
+            budget -= std::min(budget, static_cast<size_t>(received));
+            if (static_cast<size_t>(received) < sizeof(chunk)) {
+                break;
+            }
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        status = (received < 0 && errno == EBADF) ? ReadStatus::GONE : ReadStatus::CLOSED;
+        break;
+    }
+
+    size_t offset = 0;
+    while (pending->size() - offset >= sizeof(uint32_t)) {
+        uint32_t networkLength;
+        std::memcpy(&networkLength, pending->data() + offset, sizeof(networkLength));
+        uint32_t length = ntohl(networkLength);
+        if (length == 0 || length > Constants::MAX_MESSAGE_SIZE) {
+            status = ReadStatus::CLOSED;  // Same rule as NetworkStream::receive()
+            break;
+        }
+        if (pending->size() - offset - sizeof(networkLength) < length) {
+            break;
+        }
+        frames.emplace_back(*pending, offset + sizeof(networkLength), length);
+        offset += sizeof(networkLength) + length;
+    }
+
+    if (offset == pending->size() || status != ReadStatus::OPEN) {
+        std::string().swap(*pending);  // Idle connections keep no heap buffer
+    } else if (offset > 0) {
+        pending->erase(0, offset);
+    }
+    return status;
+}
+
+void EventLoop::forget(int socket) {
+    if (std::string* pending = buffer(socket, false)) {
+        std::string().swap(*pending);
+    }
+}
+
+bool EventLoop::hasPartialFrame(int socket) const {
+    const std::string* pending = buffer(socket);
+    return pending && !pending->empty();
+}
@@ -0,0 +1,244 @@
+#include "Server/Handoff.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Utils.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t MAX_PACKET_SIZE = 64 * 1024;
+
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Handoff socket path too long: " + path);
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+} // namespace
+
+HandoffChannel::~HandoffChannel() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(path.c_str());
+    }
+}
+
+bool HandoffChannel::listen(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        LOG_ERROR("Cannot create handoff socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    ::unlink(socketPath.c_str());  // Left over by a crashed upgrade
+    path = socketPath;
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, 1) < 0) {
+        LOG_ERROR("Cannot listen on handoff socket " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool HandoffChannel::accept(int timeoutMs) {
+    if (!waitReadable(listenFd, timeoutMs)) {
+        return false;
+    }
+    fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Cannot accept handoff connection: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool HandoffChannel::connect(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        LOG_ERROR("Cannot connect to handoff socket " + socketPath + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool HandoffChannel::waitReadable(int socket, int timeoutMs) {
+    pollfd entry{socket, POLLIN, 0};
+    while (true) {
+        int ready = ::poll(&entry, 1, timeoutMs);
+        if (ready > 0) {
+            return true;
+        }
+        if (ready == 0) {
+            LOG_ERROR("Handoff peer did not answer in time");
+            return false;
+        }
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool HandoffChannel::sendWord(const std::string& word) {
+    return ::send(fd, word.data(), word.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(word.size());
+}
+
+std::optional<std::string> HandoffChannel::receiveWord(int timeoutMs) {
+    if (!waitReadable(fd, timeoutMs)) {
+        return std::nullopt;
+    }
+    char buffer[64];
+    ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+        return std::nullopt;
+    }
+    return std::string(buffer, static_cast<size_t>(received));
+}
+
+bool HandoffChannel::sendBatch(const std::string& text, const std::vector<int>& fds) {
+    iovec data{const_cast<char*>(text.data()), text.size()};
+    msghdr header{};
+    header.msg_iov = &data;
+    header.msg_iovlen = 1;
+
+    std::vector<char> control;
+    if (!fds.empty()) {
+        control.resize(CMSG_SPACE(sizeof(int) * fds.size()));
+        header.msg_control = control.data();
+        header.msg_controllen = control.size();
+
+        cmsghdr* rights = CMSG_FIRSTHDR(&header);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        std::memcpy(CMSG_DATA(rights), fds.data(), sizeof(int) * fds.size());
+    }
+
+    if (::sendmsg(fd, &header, MSG_NOSIGNAL) != static_cast<ssize_t>(text.size())) {
+        LOG_ERROR("Cannot send handoff batch: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool HandoffChannel::sendState(const HandoffState& state) {
+    if (!sendBatch("LISTEN\n", {state.listenSocket})) {
+        return false;
+    }
+
+    std::string text;
+    std::vector<int> fds;
+    for (const HandoffClient& client : state.clients) {
+        text += "CLIENT;" + client.username + ";" + std::to_string(client.idleMs) + ";" +
+                (client.waitingForPong ? "1" : "0") + "\n";
+        fds.push_back(client.socket);
+
+        if (fds.size() == Constants::HANDOFF_BATCH_FDS) {
+            if (!sendBatch(text, fds)) {
+                return false;
+            }
+            text.clear();
+            fds.clear();
+        }
+    }
+    if (!fds.empty() && !sendBatch(text, fds)) {
+        return false;
+    }
+    return sendBatch("END\n", {});
+}
+
+bool HandoffChannel::receiveState(HandoffState& state, int timeoutMs) {
+    std::vector<char> buffer(MAX_PACKET_SIZE);
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * Constants::HANDOFF_BATCH_FDS));
+
+    while (true) {
+        if (!waitReadable(fd, timeoutMs)) {
+            return false;
+        }
+
+        iovec data{buffer.data(), buffer.size()};
+        msghdr header{};
+        header.msg_iov = &data;
+        header.msg_iovlen = 1;
+        header.msg_control = control.data();
+        header.msg_controllen = control.size();
+
+        ssize_t received = ::recvmsg(fd, &header, MSG_CMSG_CLOEXEC);
+        if (received <= 0) {
+            LOG_ERROR("Handoff channel closed before the end of the transfer");
+            return false;
+        }
+        if (header.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+            LOG_ERROR("Handoff batch truncated");
+            return false;
+        }
+
+        std::vector<int> fds;
+        for (cmsghdr* entry = CMSG_FIRSTHDR(&header); entry; entry = CMSG_NXTHDR(&header, entry)) {
+            if (entry->cmsg_level == SOL_SOCKET && entry->cmsg_type == SCM_RIGHTS) {
+                size_t count = (entry->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                size_t offset = fds.size();
+                fds.resize(offset + count);
+                std::memcpy(fds.data() + offset, CMSG_DATA(entry), count * sizeof(int));
+            }
+        }
+
+        // One line per descriptor, in the same order
+        std::string text(buffer.data(), static_cast<size_t>(received));
+        size_t next = 0;
+        for (const std::string& line : Utils::split(text, "\n")) {
+            if (line.empty()) {
+                continue;
+            }
+            if (line == "END") {
+                return true;
+            }
+            if (next >= fds.size()) {
+                LOG_ERROR("Handoff batch carries fewer sockets than entries");
+                return false;
+            }
+
+            int socket = fds[next++];
+            if (line == "LISTEN") {
+                state.listenSocket = socket;
+                continue;
+            }
+
+            auto fields = Utils::split(line, ";");
+            if (fields.size() != 4 || fields[0] != "CLIENT") {
+                LOG_ERROR("Malformed handoff entry: " + line);
+                ::close(socket);
+                continue;
+            }
+            HandoffClient client;
+            client.socket = socket;
+            client.username = fields[1];
+            client.idleMs = std::strtoll(fields[2].c_str(), nullptr, 10);
+            client.waitingForPong = fields[3] == "1";
+            state.clients.push_back(std::move(client));
+        }
+    }
+}
@@ -0,0 +1,360 @@
+#include "Server/HistoryStore.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/Utils.hpp"
+#include "Utils/BinaryIO.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @class HistoryStore::MappedSegment
+ * @brief Read-only mapping of a segment for the duration of a query
+ */
+class HistoryStore::MappedSegment {
+public:
+    MappedSegment(const std::string& indexPath, const std::string& dataPath, const Segment& segment)
+        : segment(segment) {
+        if (segment.count == 0) {
+            return;
+        }
+        indexSize = segment.count * sizeof(IndexRecord);
+        indexMap = map(indexPath, indexSize);
+        dataMap = map(dataPath, segment.dataSize);
+    }
+
+    ~MappedSegment() {
+        if (indexMap) {
+            ::munmap(indexMap, indexSize);
+        }
+        if (dataMap) {
+            ::munmap(dataMap, segment.dataSize);
+        }
+    }
+
+    MappedSegment(const MappedSegment&) = delete;
+    MappedSegment& operator=(const MappedSegment&) = delete;
+
+    bool valid() const { return indexMap && dataMap; }
+    const IndexRecord* index() const { return static_cast<const IndexRecord*>(indexMap); }
+    const char* data() const { return static_cast<const char*>(dataMap); }
+
+    const Segment segment;
+
+private:
+    static void* map(const std::string& path, size_t size) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // The mapping keeps the file referenced
+        return address == MAP_FAILED ? nullptr : address;
+    }
+
+    size_t indexSize = 0;
+    void* indexMap = nullptr;
+    void* dataMap = nullptr;
+};
+
+HistoryStore::HistoryStore(std::string directory)
+    : directory(std::move(directory)) {
+}
+
+HistoryStore::~HistoryStore() {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    for (auto& [owner, user] : users) {
+        std::lock_guard<std::mutex> userLock(user->mutex);
+        closeFiles(*user);
+    }
+}
+
+bool HistoryStore::open() {
+    if (::mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("Cannot create history directory: " + directory);
+        return false;
+    }
+    return true;
+}
+
+std::string HistoryStore::segmentPath(const std::string& owner, uint64_t firstSeq, const char* extension) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llu.%s", static_cast<unsigned long long>(firstSeq), extension);
+    return directory + "/" + owner + "/" + name;
+}
+
+HistoryStore::UserHistory& HistoryStore::getUser(const std::string& owner) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    auto& user = users[owner];
+    if (!user) {
+        user = std::make_unique<UserHistory>();
+    }
+    return *user;  // Never erased: the reference stays valid
+}
+
+bool HistoryStore::load(const std::string& owner, UserHistory& user) {
+    if (user.loaded) {
+        return true;
+    }
+    user.loaded = true;
+
+    DIR* dir = ::opendir((directory + "/" + owner).c_str());
+    if (!dir) {
+        return true;  // No history yet
+    }
+
+    std::vector<uint64_t> ids;
+    while (dirent* entry = ::readdir(dir)) {
+        unsigned long long firstSeq;
+        char extension[8];
+        if (std::sscanf(entry->d_name, "%16llu.%3s", &firstSeq, extension) == 2 && std::strcmp(extension, "idx") == 0) {
+            ids.push_back(firstSeq);
+        }
+    }
+    ::closedir(dir);
+    std::sort(ids.begin(), ids.end());
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        std::string indexPath = segmentPath(owner, ids[i], "idx");
+        std::string dataPath = segmentPath(owner, ids[i], "dat");
+        struct stat indexInfo, dataInfo;
+        if (::stat(indexPath.c_str(), &indexInfo) < 0 || ::stat(dataPath.c_str(), &dataInfo) < 0) {
+            LOG_WARNING("Incomplete history segment " + indexPath);
+            continue;
+        }
+
+        Segment segment{ids[i], static_cast<uint64_t>(indexInfo.st_size) / sizeof(IndexRecord), 0, 0};
+        int fd = ::open(indexPath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Drop index entries whose data never made it to disk (crash between the two writes)
+        IndexRecord last{};
+        while (segment.count > 0) {
+            off_t offset = static_cast<off_t>((segment.count - 1) * sizeof(IndexRecord));
+            if (::pread(fd, &last, sizeof(last), offset) == static_cast<ssize_t>(sizeof(last)) &&
+                static_cast<uint64_t>(last.offset) + last.length <= static_cast<uint64_t>(dataInfo.st_size)) {
+                break;
+            }
+            segment.count--;
+        }
+        ::close(fd);
+
+        if (segment.count > 0) {
+            segment.dataSize = static_cast<uint64_t>(last.offset) + last.length;
+            segment.lastTimestamp = last.timestamp;
+        }
+
+        // The tail of the last segment is truncated so new records follow the valid ones
+        bool isLast = i + 1 == ids.size();
+        if (isLast && (static_cast<uint64_t>(indexInfo.st_size) != segment.count * sizeof(IndexRecord) ||
+                       static_cast<uint64_t>(dataInfo.st_size) != segment.dataSize)) {
+            LOG_WARNING("Truncating torn history tail of " + owner);
+            (void)::truncate(indexPath.c_str(), static_cast<off_t>(segment.count * sizeof(IndexRecord)));
+            (void)::truncate(dataPath.c_str(), static_cast<off_t>(segment.dataSize));
+        }
+        user.segments.push_back(segment);
+    }
+    return true;
+}
+
+bool HistoryStore::openActive(const std::string& owner, UserHistory& user) {
+    if (user.dataFd >= 0) {
+        return true;
+    }
+
+    std::string userDirectory = directory + "/" + owner;
+    if (::mkdir(userDirectory.c_str(), 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("Cannot create history directory: " + userDirectory);
+        return false;
+    }
+
+    const Segment& active = user.segments.back();
+    user.dataFd = ::open(segmentPath(owner, active.firstSeq, "dat").c_str(), O_WRONLY | O_CREAT, 0644);
+    user.indexFd = ::open(segmentPath(owner, active.firstSeq, "idx").c_str(), O_WRONLY | O_CREAT, 0644);
+    if (user.dataFd < 0 || user.indexFd < 0) {
+        LOG_ERROR("Cannot open history segment of " + owner + ": " + std::strerror(errno));
+        closeFiles(user);
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::closeFiles(UserHistory& user) {
+    if (user.dataFd >= 0) {
+        ::close(user.dataFd);
+        user.dataFd = -1;
+    }
+    if (user.indexFd >= 0) {
+        ::close(user.indexFd);
+        user.indexFd = -1;
+    }
+}
+
+void HistoryStore::record(const std::string& owner, const Message& msg) {
+    if (!Utils::isValidUsername(owner)) {
+        return;
+    }
+
+    UserHistory& user = getUser(owner);
+    std::lock_guard<std::mutex> lock(user.mutex);
+    load(owner, user);
+
+    // Roll to a new segment when the active one is full
+    if (user.segments.empty() || user.segments.back().dataSize >= Constants::HISTORY_SEGMENT_SIZE) {
+        uint64_t firstSeq = user.segments.empty() ? 1 : user.segments.back().firstSeq + user.segments.back().count;
+        int64_t lastTimestamp = user.segments.empty() ? 0 : user.segments.back().lastTimestamp;
+        closeFiles(user);
+        user.segments.push_back(Segment{firstSeq, 0, 0, lastTimestamp});
+    }
+    if (!openActive(owner, user)) {
+        return;
+    }
+
+    int64_t timestamp = static_cast<int64_t>(std::chrono::system_clock::to_time_t(msg.timestamp));
+    std::string record;
+    record.reserve(24 + msg.payloadSize());
+    Utils::putString(record, msg.from);
+    Utils::putString(record, msg.to);
+    Utils::putString(record, msg.subject);
+    Utils::putString(record, msg.body);
+    Utils::putU64(record, static_cast<uint64_t>(timestamp));
+
+    Segment& active = user.segments.back();
+    IndexRecord entry{active.firstSeq + active.count, std::max(timestamp, active.lastTimestamp),
+                      static_cast<uint32_t>(active.dataSize), static_cast<uint32_t>(record.size())};
+
+    // Data first: an index entry never points past the data on disk
+    if (::pwrite(user.dataFd, record.data(), record.size(), static_cast<off_t>(active.dataSize)) != static_cast<ssize_t>(record.size()) ||
+        ::pwrite(user.indexFd, &entry, sizeof(entry), static_cast<off_t>(active.count * sizeof(IndexRecord))) != static_cast<ssize_t>(sizeof(entry))) {
+        LOG_ERROR("Cannot write history of " + owner + ": " + std::strerror(errno));
+        return;
+    }
+
+    active.count++;
+    active.dataSize += record.size();
+    active.lastTimestamp = entry.timestamp;
+}
+
+bool HistoryStore::readRange(const MappedSegment& mapped, uint64_t firstIndex, int64_t maxTimestamp,
+                             size_t count, HistoryPage& page) {
+    const IndexRecord* index = mapped.index();
+    for (uint64_t i = firstIndex; i < mapped.segment.count && page.entries.size() < count; ++i) {
+        if (index[i].timestamp > maxTimestamp) {
+            return false;  // Past the end of the time range
+        }
+
+        HistoryEntry entry;
+        uint64_t timestamp = 0;
+        Utils::BinaryReader reader(mapped.data() + index[i].offset, index[i].length);
+        if (!reader.str(entry.from) || !reader.str(entry.to) || !reader.str(entry.subject) ||
+            !reader.str(entry.body) || !reader.u64(timestamp)) {
+            LOG_WARNING("Corrupted history record " + std::to_string(index[i].seq));
+            continue;
+        }
+        entry.seq = index[i].seq;
+        entry.timestamp = static_cast<int64_t>(timestamp);
+        page.entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+HistoryPage HistoryStore::bySequence(const std::string& owner, uint64_t start, size_t count) {
+    HistoryPage page;
+    UserHistory& user = getUser(owner);
+    std::lock_guard<std::mutex> lock(user.mutex);
+    load(owner, user);
+
+    if (user.segments.empty() || count == 0) {
+        return page;
+    }
+    uint64_t lastSeq = user.segments.back().firstSeq + user.segments.back().count - 1;
+    if (start == 0) {
+        start = lastSeq > count ? lastSeq - count + 1 : 1;
+    }
+
+    // Last segment starting at or before the requested sequence number
+    auto it = std::upper_bound(user.segments.begin(), user.segments.end(), start,
+        [](uint64_t seq, const Segment& segment) { return seq < segment.firstSeq; });
+    if (it != user.segments.begin()) {
+        --it;
+    }
+
+    for (; it != user.segments.end() && page.entries.size() < count; ++it) {
+        uint64_t firstIndex = start > it->firstSeq ? start - it->firstSeq : 0;
+        if (firstIndex >= it->count) {
+            continue;
+        }
+        MappedSegment mapped(segmentPath(owner, it->firstSeq, "idx"), segmentPath(owner, it->firstSeq, "dat"), *it);
+        if (!mapped.valid()) {
+            LOG_ERROR("Cannot map history segment of " + owner);
+            break;
+        }
+        readRange(mapped, firstIndex, INT64_MAX, count, page);
+    }
+
+    if (!page.entries.empty() && page.entries.back().seq < lastSeq) {
+        page.nextSeq = page.entries.back().seq + 1;
+    }
+    return page;
+}
+
+HistoryPage HistoryStore::byTime(const std::string& owner, int64_t from, int64_t to, size_t count, uint64_t fromSeq) {
+    HistoryPage page;
+    UserHistory& user = getUser(owner);
+    std::lock_guard<std::mutex> lock(user.mutex);
+    load(owner, user);
+
+    if (user.segments.empty() || count == 0 || from > to) {
+        return page;
+    }
+    uint64_t lastSeq = user.segments.back().firstSeq + user.segments.back().count - 1;
+    bool inRange = true;
+
+    for (const Segment& segment : user.segments) {
+        if (!inRange || page.entries.size() >= count) {
+            break;
+        }
+        if (segment.count == 0 || segment.lastTimestamp < from || segment.firstSeq + segment.count <= fromSeq) {
+            continue;
+        }
+
+        MappedSegment mapped(segmentPath(owner, segment.firstSeq, "idx"), segmentPath(owner, segment.firstSeq, "dat"), segment);
+        if (!mapped.valid()) {
+            LOG_ERROR("Cannot map history segment of " + owner);
+            break;
+        }
+
+        // Index timestamps are non-decreasing: binary search for the start of the range
+        const IndexRecord* begin = mapped.index();
+        const IndexRecord* end = begin + segment.count;
+        const IndexRecord* first = std::lower_bound(begin, end, from,
+            [](const IndexRecord& record, int64_t value) { return record.timestamp < value; });
+        uint64_t firstIndex = static_cast<uint64_t>(first - begin);
+        if (fromSeq > segment.firstSeq) {
+            firstIndex = std::max(firstIndex, fromSeq - segment.firstSeq);
+        }
+        inRange = readRange(mapped, firstIndex, to, count, page);
+    }
+
+    if (inRange && !page.entries.empty() && page.entries.size() >= count && page.entries.back().seq < lastSeq) {
+        page.nextSeq = page.entries.back().seq + 1;
+    }
+    return page;
+}
+
+void HistoryStore::release(const std::string& owner) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    auto it = users.find(owner);
+    if (it != users.end()) {
+        std::lock_guard<std::mutex> userLock(it->second->mutex);
+        closeFiles(*it->second);
+    }
+}
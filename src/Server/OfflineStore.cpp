@@ -0,0 +1,634 @@
+#include "Server/OfflineStore.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include "Utils/BinaryIO.hpp"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+using Utils::putU32;
+using Utils::putU64;
+using Utils::putString;
+
+constexpr size_t HEADER_SIZE = 9;  // [u32 payload length][u32 checksum][u8 type]
+
+uint32_t checksum(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int64_t nowUnixMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+OfflineStore::OfflineStore(std::string directory) : directory(std::move(directory)) {
+}
+
+OfflineStore::~OfflineStore() {
+    close();
+}
+
+std::string OfflineStore::segmentPath(uint32_t id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%08u.log", id);
+    return directory + "/" + name;
+}
+
+bool OfflineStore::open() {
+    if (::mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("Cannot create offline store directory: " + directory);
+        return false;
+    }
+
+    if (!recover()) {
+        return false;
+    }
+
+    running = true;
+    writer = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+void OfflineStore::close() {
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    writerCv.notify_all();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (activeFd >= 0) {
+        ::fdatasync(activeFd);
+        ::close(activeFd);
+        activeFd = -1;
+    }
+    writtenCv.notify_all();
+    LOG_INFO("Offline store closed (" + std::to_string(pendingCount) + " pending message(s))");
+}
+
+bool OfflineStore::recover() {
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        LOG_ERROR("Cannot read offline store directory: " + directory);
+        return false;
+    }
+
+    std::vector<uint32_t> ids;
+    while (dirent* item = ::readdir(dir)) {
+        unsigned int id;
+        char tail;
+        if (std::sscanf(item->d_name, "segment-%8u.lo%c", &id, &tail) == 2 && tail == 'g') {
+            ids.push_back(id);
+        }
+    }
+    ::closedir(dir);
+    std::sort(ids.begin(), ids.end());
+
+    for (uint32_t id : ids) {
+        segments.push_back(Segment{id, 0, 0});
+        uint64_t validSize = 0;
+        recoverSegment(id, validSize);
+        segments.back().size = validSize;
+    }
+
+    if (segments.empty()) {
+        segments.push_back(Segment{1, 0, 0});
+    }
+
+    recoveryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    recoveredCount = pendingCount;
+    LOG_INFO("Offline store recovered " + std::to_string(pendingCount) + " pending message(s) from " +
+             std::to_string(ids.size()) + " segment(s) in " + std::to_string(static_cast<long>(recoveryMs)) + " ms");
+    return true;
+}
+
+size_t OfflineStore::recoverSegment(uint32_t id, uint64_t& validSize) {
+    std::string path = segmentPath(id);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_WARNING("Cannot open segment " + path);
+        return 0;
+    }
+
+    struct stat info;
+    ::fstat(fd, &info);
+    std::string content(static_cast<size_t>(info.st_size), '\0');
+    size_t total = 0;
+    while (total < content.size()) {
+        ssize_t n = ::read(fd, &content[total], content.size() - total);
+        if (n <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    content.resize(total);
+
+    int64_t now = nowUnixMs();
+    size_t records = 0;
+    size_t offset = 0;
+
+    while (offset + HEADER_SIZE <= content.size()) {
+        uint32_t length;
+        uint32_t sum;
+        std::memcpy(&length, content.data() + offset, sizeof(length));
+        std::memcpy(&sum, content.data() + offset + 4, sizeof(sum));
+        auto type = static_cast<RecordType>(content[offset + 8]);
+
+        if (offset + HEADER_SIZE + length > content.size()) {
+            break;  // Torn write at the tail
+        }
+
+        const char* payload = content.data() + offset + HEADER_SIZE;
+        if (checksum(payload, length) != sum) {
+            break;
+        }
+
+        Utils::BinaryReader reader(payload, length);
+        uint64_t seq = 0;
+        std::string to;
+
+        if (type == RecordType::STORE) {
+            uint64_t expiresAt = 0;
+            if (reader.u64(seq) && reader.u64(expiresAt) && reader.str(to)) {
+                if (expiresAt == 0 || static_cast<int64_t>(expiresAt) > now) {
+                    uint32_t size = static_cast<uint32_t>(HEADER_SIZE + length);
+                    index[to].push_back(Entry{seq, id, size, offset, EntryState::PENDING, static_cast<int64_t>(expiresAt)});
+                    segments.back().live++;
+                    pendingCount++;
+                    storedBytes += size;
+                    recipientBytes[to] += size;
+                }
+            }
+        } else if (type == RecordType::ACK) {
+            if (reader.u64(seq) && reader.str(to)) {
+                Entry* entry = findEntry(to, seq);
+                if (entry && entry->state != EntryState::ACKED) {
+                    retire(to, *entry);
+                }
+            }
+        }
+
+        nextSeq = std::max(nextSeq, seq + 1);
+        offset += HEADER_SIZE + length;
+        records++;
+    }
+
+    validSize = offset;
+    if (offset < content.size()) {
+        LOG_WARNING("Truncating damaged tail of " + path + " at offset " + std::to_string(offset));
+        if (::truncate(path.c_str(), static_cast<off_t>(offset)) < 0) {
+            LOG_ERROR("Cannot truncate " + path);
+        }
+    }
+    return records;
+}
+
+void OfflineStore::appendRecord(RecordType type, const std::string& payload, uint64_t& offset, uint32_t& segment) {
+    std::string record;
+    record.reserve(HEADER_SIZE + payload.size());
+    putU32(record, static_cast<uint32_t>(payload.size()));
+    putU32(record, checksum(payload.data(), payload.size()));
+    record.push_back(static_cast<char>(type));
+    record.append(payload);
+
+    // Roll to a new segment when the active one is full
+    Segment* active = &segments.back();
+    if (active->size > 0 && active->size + record.size() > Constants::OFFLINE_SEGMENT_SIZE) {
+        segments.push_back(Segment{active->id + 1, 0, 0});
+        active = &segments.back();
+    }
+
+    offset = active->size;
+    segment = active->id;
+    active->size += record.size();
+
+    if (pendingChunks.empty() || pendingChunks.back().segment != segment) {
+        pendingChunks.push_back(Chunk{segment, std::string()});
+    }
+    pendingChunks.back().data.append(record);
+    pendingBytes += record.size();
+    appendedTicket++;
+    writerCv.notify_one();
+}
+
+uint64_t OfflineStore::append(const Message& msg, bool inFlight, std::string* rejection) {
+    auto [maxPerUserKb, maxTotalMb, ttlH] = RuntimeConfig::getInstance().read([](const ConfigSnapshot& config) {
+        return std::make_tuple(config.offlineMaxKbPerUser, config.offlineMaxMb, config.offlineTtlH);
+    });
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!running) {
+        return 0;
+    }
+
+    // Without its own ttl=, mail expires after OFFLINE_TTL_H
+    uint64_t expiresAt = 0;
+    if (msg.expiresAt.time_since_epoch().count() != 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            msg.expiresAt - std::chrono::steady_clock::now()).count();
+        expiresAt = static_cast<uint64_t>(nowUnixMs() + std::max<int64_t>(remaining, 1));
+    } else if (ttlH > 0) {
+        expiresAt = static_cast<uint64_t>(nowUnixMs() + static_cast<int64_t>(ttlH) * 3600 * 1000);
+    }
+
+    uint64_t seq = nextSeq;
+    std::string payload;
+    payload.reserve(48 + msg.payloadSize());
+    putU64(payload, seq);
+    putU64(payload, expiresAt);
+    putString(payload, msg.to);
+    putString(payload, msg.from);
+    putString(payload, msg.subject);
+    putString(payload, msg.body);
+    putU64(payload, static_cast<uint64_t>(std::chrono::system_clock::to_time_t(msg.timestamp)));
+    payload.push_back(static_cast<char>(msg.priority));
+
+    // Only mail left for later is refused: a message in flight is being delivered now
+    uint32_t size = static_cast<uint32_t>(HEADER_SIZE + payload.size());
+    if (!inFlight) {
+        const char* budget = nullptr;
+        auto used = recipientBytes.find(msg.to);
+        if ((used != recipientBytes.end() ? used->second : 0) + size > static_cast<uint64_t>(maxPerUserKb) * 1024) {
+            budget = "mailbox of recipient is full (OFFLINE_MAX_KB_PER_USER)";
+        } else if (storedBytes + size > static_cast<uint64_t>(maxTotalMb) * 1024 * 1024) {
+            budget = "offline store is full (OFFLINE_MAX_MB)";
+        }
+        if (budget) {
+            rejectedCount++;
+            LOG_WARNING("Offline message from " + msg.from + " to " + msg.to + " rejected: " + budget);
+            if (rejection) {
+                *rejection = budget;
+            }
+            return 0;
+        }
+    }
+
+    nextSeq++;
+    uint64_t offset;
+    uint32_t segment;
+    appendRecord(RecordType::STORE, payload, offset, segment);
+
+    index[msg.to].push_back(Entry{seq, segment, size, offset, inFlight ? EntryState::IN_FLIGHT : EntryState::PENDING,
+                                  static_cast<int64_t>(expiresAt)});
+    segments.back().live++;  // appendRecord() always writes to the last segment
+    pendingCount++;
+    storedBytes += size;
+    recipientBytes[msg.to] += size;
+    return seq;
+}
+
+bool OfflineStore::decodeMessage(const std::string& record, Message& msg) {
+    if (record.size() < HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t length;
+    uint32_t sum;
+    std::memcpy(&length, record.data(), sizeof(length));
+    std::memcpy(&sum, record.data() + 4, sizeof(sum));
+    if (HEADER_SIZE + length != record.size() || checksum(record.data() + HEADER_SIZE, length) != sum) {
+        return false;
+    }
+
+    Utils::BinaryReader reader(record.data() + HEADER_SIZE, length);
+    uint64_t seq, expiresAt, timestamp;
+    uint8_t priority;
+    if (!reader.u64(seq) || !reader.u64(expiresAt) || !reader.str(msg.to) || !reader.str(msg.from) ||
+        !reader.str(msg.subject) || !reader.str(msg.body) || !reader.u64(timestamp) || !reader.u8(priority)) {
+        return false;
+    }
+
+    msg.storeSeq = seq;
+    msg.timestamp = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(timestamp));
+    msg.priority = static_cast<MessagePriority>(priority);
+    if (expiresAt != 0) {
+        msg.expiresAt = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(static_cast<int64_t>(expiresAt) - nowUnixMs());
+    }
+    return true;
+}
+
+std::vector<Message> OfflineStore::takePending(const std::string& username) {
+    std::vector<Entry> locations;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        auto it = index.find(username);
+        if (it == index.end()) {
+            return {};
+        }
+        for (Entry& entry : it->second) {
+            if (entry.state == EntryState::PENDING) {
+                entry.state = EntryState::IN_FLIGHT;
+                locations.push_back(entry);
+            }
+        }
+    }
+
+    if (locations.empty()) {
+        return {};
+    }
+
+    // The records may still sit in the write buffer
+    flush();
+
+    std::vector<Message> result;
+    result.reserve(locations.size());
+    int fd = -1;
+    uint32_t fdSegment = 0;
+    auto steadyNow = std::chrono::steady_clock::now();
+
+    for (const Entry& entry : locations) {
+        if (fd < 0 || fdSegment != entry.segment) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            fd = ::open(segmentPath(entry.segment).c_str(), O_RDONLY);
+            fdSegment = entry.segment;
+        }
+
+        std::string record(entry.length, '\0');
+        Message msg;
+        if (fd < 0 || ::pread(fd, &record[0], entry.length, static_cast<off_t>(entry.offset)) != static_cast<ssize_t>(entry.length) ||
+            !decodeMessage(record, msg)) {
+            LOG_ERROR("Corrupted offline record " + std::to_string(entry.seq) + " for " + username);
+            acknowledge(username, entry.seq);
+            continue;
+        }
+
+        if (msg.expiresAt.time_since_epoch().count() != 0 && msg.expiresAt <= steadyNow) {
+            acknowledge(username, entry.seq);
+            continue;
+        }
+        result.push_back(std::move(msg));
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return result;
+}
+
+OfflineStore::Entry* OfflineStore::findEntry(const std::string& username, uint64_t seq) {
+    auto it = index.find(username);
+    if (it == index.end()) {
+        return nullptr;
+    }
+
+    auto& entries = it->second;
+    auto pos = std::lower_bound(entries.begin(), entries.end(), seq,
+        [](const Entry& entry, uint64_t value) { return entry.seq < value; });
+    return (pos != entries.end() && pos->seq == seq) ? &*pos : nullptr;
+}
+
+void OfflineStore::retire(const std::string& username, Entry& entry) {
+    entry.state = EntryState::ACKED;
+    pendingCount--;
+    storedBytes -= entry.length;
+    auto charged = recipientBytes.find(username);
+    if (charged != recipientBytes.end()) {
+        charged->second -= entry.length;
+        if (charged->second == 0) {
+            recipientBytes.erase(charged);
+        }
+    }
+
+    auto segment = std::lower_bound(segments.begin(), segments.end(), entry.segment,
+        [](const Segment& item, uint32_t id) { return item.id < id; });
+    if (segment != segments.end() && segment->id == entry.segment) {
+        segment->live--;
+    }
+
+    auto it = index.find(username);
+    while (!it->second.empty() && it->second.front().state == EntryState::ACKED) {
+        it->second.pop_front();
+    }
+    if (it->second.empty()) {
+        index.erase(it);
+    }
+
+    // Only a prefix of the log may go: ACKs always live after their STORE
+    while (segments.size() > 1 && segments.front().live == 0) {
+        obsoleteSegments.push_back(segments.front().id);
+        segments.pop_front();
+    }
+}
+
+void OfflineStore::release(const std::string& username, uint64_t seq) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    Entry* entry = findEntry(username, seq);
+    if (entry && entry->state == EntryState::IN_FLIGHT) {
+        entry->state = EntryState::PENDING;
+    }
+}
+
+void OfflineStore::acknowledge(const std::string& username, uint64_t seq) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    acknowledgeLocked(username, seq);
+}
+
+void OfflineStore::acknowledgeLocked(const std::string& username, uint64_t seq) {
+    Entry* entry = findEntry(username, seq);
+    if (!entry || entry->state == EntryState::ACKED || !running) {
+        return;
+    }
+
+    std::string payload;
+    putU64(payload, seq);
+    putString(payload, username);
+
+    uint64_t offset;
+    uint32_t segment;
+    appendRecord(RecordType::ACK, payload, offset, segment);
+    retire(username, *entry);
+}
+
+void OfflineStore::expireStale() {
+    // Mail never taken (e.g. for names that never connect) is retired like delivered mail
+    int64_t now = nowUnixMs();
+    std::vector<std::pair<std::string, uint64_t>> expired;
+    for (const auto& [username, entries] : index) {
+        for (const Entry& entry : entries) {
+            if (entry.state == EntryState::PENDING && entry.expiresAtMs != 0 && entry.expiresAtMs <= now) {
+                expired.emplace_back(username, entry.seq);
+            }
+        }
+    }
+    for (const auto& [username, seq] : expired) {
+        acknowledgeLocked(username, seq);
+    }
+    if (!expired.empty()) {
+        expiredCount += expired.size();
+        LOG_INFOF("Offline store: {} expired message(s) removed", expired.size());
+    }
+}
+
+void OfflineStore::flush() {
+    std::unique_lock<std::mutex> lock(storeMutex);
+    uint64_t target = appendedTicket;
+    writtenCv.wait(lock, [this, target] { return writtenTicket >= target || !running; });
+}
+
+bool OfflineStore::sync() {
+    std::unique_lock<std::mutex> lock(storeMutex);
+    uint64_t target = appendedTicket;
+    if (syncedTicket < target && running) {
+        syncRequested = std::max(syncRequested, target);
+        writerCv.notify_one();
+        writtenCv.wait(lock, [this, target] { return syncedTicket >= target || !running; });
+    }
+    return syncedTicket >= target && failedTicket < target;
+}
+
+bool OfflineStore::syncDirectory() {
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool OfflineStore::writeChunk(const Chunk& chunk) {
+    if (activeFd < 0 || activeFdSegment != chunk.segment) {
+        if (activeFd >= 0) {
+            // Later syncs only cover the active segment: settle the previous one now
+            ::fdatasync(activeFd);
+            ::close(activeFd);
+        }
+        struct stat info;
+        bool created = ::stat(segmentPath(chunk.segment).c_str(), &info) < 0;
+        activeFd = ::open(segmentPath(chunk.segment).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        activeFdSegment = chunk.segment;
+        if (activeFd < 0) {
+            LOG_ERROR("Cannot open segment " + segmentPath(chunk.segment));
+            return false;
+        }
+        if (created && !syncDirectory()) {
+            LOG_WARNING("Cannot sync offline store directory: " + directory);
+        }
+    }
+
+    size_t written = 0;
+    while (written < chunk.data.size()) {
+        ssize_t n = ::write(activeFd, chunk.data.data() + written, chunk.data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Offline store write failed: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void OfflineStore::writerLoop() {
+    std::unique_lock<std::mutex> lock(storeMutex);
+    const auto sweepPeriod = std::chrono::seconds(Constants::OFFLINE_EXPIRY_SWEEP_S);
+    auto nextSweep = std::chrono::steady_clock::now() + sweepPeriod;
+
+    while (true) {
+        writerCv.wait_until(lock, nextSweep, [this] {
+            return !pendingChunks.empty() || !obsoleteSegments.empty() || syncRequested > syncedTicket || !running;
+        });
+        if (running && std::chrono::steady_clock::now() >= nextSweep) {
+            expireStale();  // Its ACKs are written with this batch
+            nextSweep = std::chrono::steady_clock::now() + sweepPeriod;
+        }
+
+        bool syncNeeded = syncRequested > syncedTicket;
+        if (pendingChunks.empty() && obsoleteSegments.empty() && !syncNeeded) {
+            if (!running) {
+                break;  // Stopped and drained
+            }
+            continue;
+        }
+
+        // Group commit: let concurrent callers join the batch before paying for the fsync
+        if (syncNeeded && running) {
+            int delayMs = RuntimeConfig::getInstance().read([](const ConfigSnapshot& config) { return config.groupCommitDelayMs; });
+            writerCv.wait_for(lock, std::chrono::milliseconds(delayMs), [this] {
+                return pendingBytes >= Constants::GROUP_COMMIT_MAX_BYTES || !running;
+            });
+        }
+
+        // Take the whole batch: one write per segment touched
+        auto chunks = std::move(pendingChunks);
+        auto obsolete = std::move(obsoleteSegments);
+        pendingChunks.clear();
+        obsoleteSegments.clear();
+        pendingBytes = 0;
+        uint64_t ticket = appendedTicket;
+        lock.unlock();
+
+        bool ok = true;
+        for (const Chunk& chunk : chunks) {
+            ok = writeChunk(chunk) && ok;
+        }
+        if (syncNeeded && activeFd >= 0 && ::fdatasync(activeFd) < 0) {
+            LOG_ERROR("Offline store fdatasync failed: " + std::string(std::strerror(errno)));
+            ok = false;
+        }
+        for (uint32_t id : obsolete) {
+            ::unlink(segmentPath(id).c_str());
+            LOG_DEBUGF("Offline segment {} deleted", id);
+        }
+
+        lock.lock();
+        if (!ok) {
+            failedTicket = ticket;
+        }
+        if (syncNeeded) {
+            syncCount++;
+            syncedRecords += ticket - syncedTicket;
+            syncedTicket = ticket;
+        }
+        writtenTicket = ticket;
+        writtenCv.notify_all();
+    }
+}
+
+OfflineStoreStats OfflineStore::getStats() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    OfflineStoreStats stats;
+    stats.pending = pendingCount;
+    stats.recipients = index.size();
+    stats.segments = segments.size();
+    for (const Segment& segment : segments) {
+        stats.diskBytes += segment.size;
+    }
+    stats.recoveryMs = recoveryMs;
+    stats.recovered = recoveredCount;
+    stats.syncs = syncCount;
+    stats.syncedRecords = syncedRecords;
+    stats.storedBytes = storedBytes;
+    stats.rejected = rejectedCount;
+    stats.expired = expiredCount;
+    return stats;
+}
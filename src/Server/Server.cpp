@@ -6,9 +6,16 @@
 #include "Utils/Constants.hpp"
 #include "Utils/NetworkStream.hpp"
 #include "Utils/MessageParser.hpp"
+#include "Utils/RuntimeConfig.hpp"
 #include <cstdlib>
+#include <cerrno>
+#include <csignal>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <unistd.h>
 #include <cstring>
 #include <thread>
@@ -18,14 +25,59 @@
 #include <iostream>
 #include <iomanip>
 
-Server::Server() {
+namespace {
+
+std::string currentExecutable() {
+    char buffer[4096];
+    ssize_t length = ::readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (length <= 0) {
+        return "";
+    }
+    std::string path(buffer, static_cast<size_t>(length));
+    
+    // The binary was replaced on disk by the new build
+    const std::string deleted = " (deleted)";
+    if (path.size() > deleted.size() && path.compare(path.size() - deleted.size(), deleted.size(), deleted) == 0) {
+        path.erase(path.size() - deleted.size());
+    }
+    return path;
+}
+
+pid_t spawnSuccessor(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    long maxFd = ::sysconf(_SC_OPEN_MAX);
+    
+    pid_t child = ::fork();
+    if (child == 0) {
+        // Inherited client sockets would outlive their close() in the new
+        // process: it only keeps the copies received over the handoff channel
+#ifdef SYS_close_range
+        if (::syscall(SYS_close_range, 3, ~0U, 0) != 0)
+#endif
+        for (long fd = 3; fd < maxFd; ++fd) {
+            ::close(static_cast<int>(fd));
+        }
+        ::execv(argv[0], argv.data());
+        ::_exit(127);
+    }
+    return child;
+}
+
+} // namespace
+
+Server::Server()
+    : banlist(Constants::DEFAULT_BANLIST) {
     adminHandler = std::make_unique<AdminCommandHandler>(this);
     commandHandler = std::make_unique<::CommandHandler>(this);
     LOG_INFO("Server created with default configuration");
 }
 
 Server::Server(const ServerConfig& configuration) 
-    : config(configuration) {
+    : config(configuration), banlist(Constants::DEFAULT_BANLIST) {
     adminHandler = std::make_unique<AdminCommandHandler>(this);
     commandHandler = std::make_unique<::CommandHandler>(this);
     LOG_INFO("Server created with custom configuration");
@@ -33,6 +85,9 @@ Server::Server(const ServerConfig& configuration)
 
 Server::~Server() {
     stop();
+    if (configSubscription != 0) {
+        RuntimeConfig::getInstance().unsubscribe(configSubscription);
+    }
 }
 
 int Server::start(int PORT, int MAX_CONNECTIONS) {
@@ -72,11 +127,8 @@ int Server::start(int PORT, int MAX_CONNECTIONS) {
         status = SERVER_STATUS::OFF;
         return -1;
     }
-    dispatcher = std::make_unique<Dispatcher>(this);
-    threadPool = std::make_unique<ThreadPool>(Constants::THREAD_POOL_SIZE);
-    
-    initializeCommands();
-    loadBanlist();
+    openOfflineStore();
+    initializeServices();
     
     startTime = std::chrono::steady_clock::now();
     
@@ -88,63 +140,344 @@ int Server::start(int PORT, int MAX_CONNECTIONS) {
     return 0;
 }
 
-void Server::banlistAdd(const std::string& username) {
-    std::lock_guard<std::mutex> lock(bannedUsersMutex);
-    bannedUsers.insert(username);
-    saveBanlist();
+void Server::openOfflineStore() {
+    offlineStore.reset();
+    if (RuntimeConfig::getInstance().read([](const ConfigSnapshot& config) { return config.offlineStoreEnabled; })) {
+        offlineStore = std::make_unique<OfflineStore>(Constants::DEFAULT_OFFLINE_DIR);
+        if (!offlineStore->open()) {
+            LOG_ERROR("Offline store unavailable - messages to offline users will be rejected");
+            offlineStore.reset();
+        }
+    }
 }
 
-bool Server::banlistRemove(const std::string& username) {
-    std::lock_guard<std::mutex> lock(bannedUsersMutex);
-    auto it = bannedUsers.find(username);
-    if (it == bannedUsers.end()) {
-        return false;
+void Server::applyLogRotation(const ConfigSnapshot& config) {
+    Logger::getInstance().setRotation(static_cast<uint64_t>(config.logRotateSizeKb) * 1024,
+                                      std::chrono::minutes(config.logRotateAgeMin),
+                                      static_cast<size_t>(config.logRotateKeep));
+}
+
+void Server::onConfigChanged(const ConfigSnapshot& config) {
+    applyLogRotation(config);
+    {
+        std::lock_guard<std::mutex> lock(monitorMutex);
+        configChanged = true;
     }
-    bannedUsers.erase(it);
-    saveBanlist();
-    return true;
+    monitorCv.notify_one();
 }
 
-bool Server::isBanned(const std::string& username) const {
-    std::lock_guard<std::mutex> lock(bannedUsersMutex);
-    return bannedUsers.find(username) != bannedUsers.end();
+void Server::initializeServices() {
+    auto& runtime = RuntimeConfig::getInstance();
+    ConfigSnapshot settings = runtime.current();
+    applyLogRotation(settings);
+    configSubscription = runtime.subscribe([this](const ConfigSnapshot& config) { onConfigChanged(config); });
+    if (!configFile.empty()) {
+        configWatcher = std::make_unique<Utils::ConfigWatcher>(configFile, [this] {
+            placement.apply(Utils::ThreadRole::MONITOR);
+        });
+        if (!configWatcher->isOpen()) {
+            LOG_WARNING("Changes to " + configFile + " will only apply after a restart");
+            configWatcher.reset();
+        }
+    }
+    
+    if (settings.historyEnabled) {
+        historyStore = std::make_unique<HistoryStore>(Constants::DEFAULT_HISTORY_DIR);
+        if (!historyStore->open()) {
+            LOG_ERROR("Message history unavailable");
+            historyStore.reset();
+        }
+    }
+    dispatcher = std::make_unique<Dispatcher>(this);
+    poolBaseSize = static_cast<size_t>(settings.threadPoolSize);
+    threadPool = std::make_unique<WorkStealingPool>(poolBaseSize, [this](size_t index) {
+        placement.apply(Utils::ThreadRole::POOL, index);
+    });
+    std::string layout = placement.describe();
+    if (!layout.empty()) {
+        LOG_INFO("Thread placement: " + layout);
+    }
+    
+    handoffEvent = ::eventfd(0, EFD_CLOEXEC);
+    if (handoffEvent < 0) {
+        LOG_WARNING("Cannot create handoff event - /upgrade disabled");
+    }
+    
+    if (eventLoopMode) {
+        eventLoop = std::make_unique<EventLoop>();
+        if (!eventLoop->open(handoffEvent)) {
+            LOG_ERROR("Event loop unavailable - falling back to a reader thread per connection");
+            eventLoop.reset();
+        }
+    }
+#ifdef ENABLE_COROUTINES
+    if (!eventLoop) {
+        ioLoop = std::make_unique<Utils::IoLoop>(Constants::IO_LOOP_THREADS, [this](size_t) {
+            placement.apply(Utils::ThreadRole::EVENTS);
+        });
+        if (!ioLoop->isOpen()) {
+            LOG_ERROR("I/O loop unavailable - falling back to a reader thread per connection");
+            ioLoop.reset();
+        }
+    }
+#endif
+    
+    initializeCommands();
+    banlist.load();
 }
 
-void Server::loadBanlist() {
-    std::lock_guard<std::mutex> lock(bannedUsersMutex);
-    std::ifstream file(Constants::DEFAULT_BANLIST);
+int Server::takeover(const std::string& channelPath, int MAX_CONNECTIONS) {
+    if (status != SERVER_STATUS::OFF) {
+        LOG_ERROR("Server is already started");
+        return -1;
+    }
     
-    if (!file.is_open()) {
-        LOG_INFO("No banlist file found, creating a new list");
-        return;
+    status = SERVER_STATUS::STARTING;
+    LOG_INFO("Taking over from the running server through " + channelPath);
+    config.max_connections = (MAX_CONNECTIONS > 0) ? MAX_CONNECTIONS : 100;
+    
+    // Everything that does not depend on the old process is ready before HELLO,
+    // so the pause only covers the transfer itself
+    initializeServices();
+    
+    HandoffChannel channel;
+    HandoffState state;
+    if (!channel.connect(channelPath) || !channel.sendWord("HELLO") ||
+        !channel.receiveState(state, Constants::HANDOFF_TIMEOUT_MS)) {
+        LOG_ERROR("Takeover failed - the old process keeps serving");
+        status = SERVER_STATUS::OFF;
+        return -1;
+    }
+    auto pauseStart = std::chrono::steady_clock::now();
+    
+    config.socket = state.listenSocket;
+    socklen_t length = sizeof(config.address);
+    if (getsockname(config.socket, (struct sockaddr*)&config.address, &length) == 0) {
+        config.port = ntohs(config.address.sin_port);
+    }
+    
+    // Flushed and closed by the old process, with its queued messages spilled into it
+    openOfflineStore();
+    for (const HandoffClient& client : state.clients) {
+        adoptClient(client);
+    }
+    for (const auto& session : getAllSessions()) {
+        dispatcher->deliverStored(session);
+    }
+    
+    if (!channel.sendWord("READY")) {
+        LOG_ERROR("Takeover failed - the old process did not acknowledge the transfer");
+        status = SERVER_STATUS::OFF;
+        return -1;
+    }
+    
+    startTime = std::chrono::steady_clock::now();
+    status = SERVER_STATUS::RUNNING;
+    createServerThreads();
+    for (const HandoffClient& client : state.clients) {
+        startReader(client.socket);
+    }
+    
+    double pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pauseStart).count();
+    std::ostringstream summary;
+    summary << "Took over " << state.clients.size() << " connection(s) on port " << config.port
+            << " (" << std::fixed << std::setprecision(1) << pauseMs << " ms after the transfer)";
+    LOG_INFO(summary.str());
+    return 0;
+}
+
+bool Server::upgrade(const std::string& binary) {
+    if (status != SERVER_STATUS::RUNNING || handoffEvent < 0) {
+        return false;
+    }
+#ifdef ENABLE_COROUTINES
+    // Suspended connection coroutines cannot be parked for the handoff
+    if (ioLoop) {
+        LOG_ERROR("Upgrade aborted: not supported with coroutine connections (use --event-loop)");
+        return false;
+    }
+#endif
+    
+    std::string executable = binary.empty() ? currentExecutable() : binary;
+    HandoffChannel channel;
+    if (executable.empty() || !channel.listen(Constants::DEFAULT_HANDOFF_SOCKET)) {
+        LOG_ERROR("Upgrade aborted: cannot prepare the handoff");
+        return false;
     }
     
-    std::string username;
-    while (std::getline(file, username)) {
-        if (!username.empty()) {
-            bannedUsers.insert(username);
+    std::vector<std::string> args = {
+        executable, "--takeover", Constants::DEFAULT_HANDOFF_SOCKET,
+        "-c", std::to_string(config.max_connections)
+    };
+    if (Logger::getInstance().isVerbose()) {
+        args.push_back("-v");
+    }
+    if (Logger::getInstance().isAsync()) {
+        args.push_back("--async-log");
+    }
+    if (!Logger::getInstance().getBinaryLogPath().empty()) {
+        args.push_back("--binary-log");  // The successor continues the same ring file
+    }
+    args.push_back("--log-level");
+    args.push_back(Logger::levelName(Logger::getInstance().getMinimumLevel()));
+    if (eventLoop) {
+        args.push_back("--event-loop");
+    }
+    if (!configFile.empty()) {
+        args.push_back("--config");
+        args.push_back(configFile);
+    }
+    for (const std::string& arg : placement.arguments()) {
+        args.push_back(arg);
+    }
+    
+    pid_t child = spawnSuccessor(args);
+    if (child < 0) {
+        LOG_ERROR("Upgrade aborted: cannot start " + executable + ": " + std::strerror(errno));
+        return false;
+    }
+    LOG_INFO("Upgrade: started " + executable + " (pid " + std::to_string(child) + ")");
+    
+    auto abort = [child](const std::string& reason) {
+        ::kill(child, SIGKILL);
+        ::waitpid(child, nullptr, 0);
+        LOG_ERROR("Upgrade aborted: " + reason);
+        return false;
+    };
+    
+    // The new process is fully initialized when it says HELLO
+    if (!channel.accept(Constants::HANDOFF_TIMEOUT_MS) ||
+        channel.receiveWord(Constants::HANDOFF_TIMEOUT_MS) != std::optional<std::string>("HELLO")) {
+        return abort("the new process did not come up");
+    }
+    
+    auto pauseStart = std::chrono::steady_clock::now();
+    if (!suspendForHandoff()) {
+        return abort("clients busy in the middle of a request, try again");
+    }
+    
+    HandoffState state = collectHandoffState();
+    if (!channel.sendState(state) ||
+        channel.receiveWord(Constants::HANDOFF_TIMEOUT_MS) != std::optional<std::string>("READY")) {
+        abort("the new process did not take the sockets over");
+        resumeAfterHandoff();
+        return false;
+    }
+    
+    double pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pauseStart).count();
+    std::ostringstream summary;
+    summary << "Upgrade complete: " << state.clients.size() << " connection(s) handed to pid " << child
+            << ", pause " << std::fixed << std::setprecision(1) << pauseMs << " ms";
+    LOG_INFO(summary.str());
+    
+    // The sockets, offline store and logs now belong to the new process:
+    // leave without the shutdown sequence of stop()
+    std::exit(0);
+}
+
+bool Server::suspendForHandoff() {
+    {
+        std::unique_lock<std::mutex> lock(handoffMutex);
+        handoffActive = true;
+        uint64_t one = 1;
+        (void)::write(handoffEvent, &one, sizeof(one));
+        
+        // Readers stop between two frames, so no request is cut in half
+        bool parked = handoffCv.wait_for(lock, std::chrono::milliseconds(Constants::HANDOFF_PARK_TIMEOUT_MS), [this] {
+            return listenerParked && (!eventLoop || eventLoopParked) && parkedConnections.size() == runningReaders;
+        });
+        
+        // Bytes of a half-received frame would be lost with the event loop's buffer
+        for (int socket : eventConnections) {
+            if (parked && eventLoop->hasPartialFrame(socket)) {
+                parked = false;
+            }
+        }
+        if (!parked) {
+            uint64_t value;
+            (void)::read(handoffEvent, &value, sizeof(value));
+            handoffActive = false;
+            handoffCv.notify_all();
+            return false;
         }
     }
     
-    file.close();
-    LOG_INFO("Banlist loaded: " + std::to_string(bannedUsers.size()) + " banned user(s)");
+    // A PING round in progress finishes before the sockets change hands
+    { std::lock_guard<std::mutex> lock(pingMutex); }
+    
+    dispatcher->suspend();
+    if (offlineStore) {
+        dispatcher->spill(*offlineStore);
+        offlineStore->close();
+    } else if (dispatcher->getStats().totalQueued > 0) {
+        LOG_WARNING("Queued messages are lost in the upgrade: the offline store is disabled");
+    }
+    return true;
 }
 
-void Server::saveBanlist() {
-    // Note: Mutex is already locked by banlistAdd
-    std::ofstream file(Constants::DEFAULT_BANLIST);
+void Server::resumeAfterHandoff() {
+    openOfflineStore();
+    dispatcher->resume();
+    for (const auto& session : getAllSessions()) {
+        dispatcher->deliverStored(session);
+    }
     
-    if (!file.is_open()) {
-        LOG_ERROR("Cannot open banlist file for writing");
-        return;
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        uint64_t value;
+        (void)::read(handoffEvent, &value, sizeof(value));
+        handoffActive = false;
     }
+    handoffCv.notify_all();
+    LOG_INFO("Upgrade aborted - this process keeps serving");
+}
+
+HandoffState Server::collectHandoffState() {
+    HandoffState state;
+    state.listenSocket = config.socket;
+    auto now = std::chrono::steady_clock::now();
     
-    for (const auto& username : bannedUsers) {
-        file << username << "\n";
+    std::lock_guard<std::mutex> handoffLock(handoffMutex);
+    for (const auto* sockets : {&parkedConnections, &pendingConnections, &eventConnections}) {
+        for (int socket : *sockets) {
+            if (closingConnections.count(socket) != 0) {
+                continue;  // Being closed: the peer has already seen the hangup
+            }
+            HandoffClient client;
+            client.socket = socket;
+            if (auto info = registry.findBySocket(socket)) {
+                client.username = info->session->getUsername();
+                client.idleMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - info->lastActivity()).count();
+                client.waitingForPong = info->waitingForPong;
+            }
+            state.clients.push_back(std::move(client));
+        }
+    }
+    return state;
+}
+
+void Server::adoptClient(const HandoffClient& client) {
+    if (client.username.empty()) {
+        return;  // Not authenticated yet: only the connection moves
     }
     
-    file.close();
-    LOG_DEBUG("Banlist saved: " + std::to_string(bannedUsers.size()) + " user(s)");
+    auto session = std::make_shared<Session>(client.username, client.socket, nextSessionGeneration++);
+    auto info = registry.insert(client.username, std::move(session));
+    info->touch(std::chrono::steady_clock::now() - std::chrono::milliseconds(client.idleMs));
+    info->waitingForPong = client.waitingForPong;
+    armHeartbeat(info);
+}
+
+void Server::banlistAdd(const std::string& username) {
+    banlist.add(username);
+}
+
+bool Server::banlistRemove(const std::string& username) {
+    return banlist.remove(username);
+}
+
+bool Server::isBanned(const std::string& username) const {
+    return banlist.contains(username);
 }
 
 void Server::stop() {
@@ -155,19 +488,27 @@ void Server::stop() {
     LOG_INFO("Stopping server...");
     status = SERVER_STATUS::STOPPING;
     
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex);
-        for (const auto& [username, info] : clients) {
-            close(info.socket);
-        }
-        clients.clear();
+    if (configSubscription != 0) {
+        RuntimeConfig::getInstance().unsubscribe(configSubscription);
+        configSubscription = 0;
+    }
+    configWatcher.reset();
+    
+    for (const auto& info : registry.snapshot()) {
+        info->session->close();
+        close(info->socket);
     }
+    registry.clear();
     
     if (config.socket > 0) {
         close(config.socket);
         config.socket = 0;
     }
     
+    if (offlineStore) {
+        offlineStore->close();
+    }
+    
     status = SERVER_STATUS::OFF;
     LOG_INFO("Server stopped");
     
@@ -175,108 +516,159 @@ void Server::stop() {
 }
 
 std::string Server::getUsernameBySocket(int socket) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    for (const auto& [username, info] : clients) {
-        if (info.socket == socket) {
-            return username;
-        }
-    }
-    return "";
+    auto info = registry.findBySocket(socket);
+    return info ? info->session->getUsername() : "";
 }
 
 int Server::getUserSocket(const std::string& username) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    auto it = clients.find(username);
-    return (it != clients.end()) ? it->second.socket : -1;
+    auto info = registry.find(username);
+    return info ? info->socket : -1;
+}
+
+std::shared_ptr<Session> Server::getSession(const std::string& username) {
+    auto info = registry.find(username);
+    return info ? info->session : nullptr;
+}
+
+std::shared_ptr<Session> Server::getSessionBySocket(int socket) {
+    auto info = registry.findBySocket(socket);
+    return info ? info->session : nullptr;
 }
 
 bool Server::isUsernameTaken(const std::string& username) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    return clients.find(username) != clients.end();
+    return registry.find(username) != nullptr;
 }
 
-void Server::registerClient(const std::string& username, int socket) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    clients[username] = ClientInfo(socket);
+std::shared_ptr<Session> Server::registerClient(const std::string& username, int socket) {
+    auto session = std::make_shared<Session>(username, socket, nextSessionGeneration++);
+    auto info = registry.tryInsert(username, session);
+    if (!info) {
+        return nullptr;
+    }
+    armHeartbeat(info);
+    return session;
 }
 
 void Server::unregisterClient(const std::string& username) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    clients.erase(username);
+    auto info = registry.remove(username);
+    if (!info) {
+        return;
+    }
+    info->session->close();
+    if (historyStore) {
+        historyStore->release(username);
+    }
 }
 
-void Server::updateClientPong(const std::string& username) {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    auto it = clients.find(username);
-    
-    if (it != clients.end()) {
-        it->second.lastPong = std::chrono::steady_clock::now();
-        it->second.waitingForPong = false;
+void Server::touchClient(int socket) {
+    if (auto info = registry.findBySocket(socket)) {
+        info->touch(std::chrono::steady_clock::now());
     }
 }
 
-
+void Server::armHeartbeat(const SessionRegistry::Entry& info) {
+#ifndef DISABLE_HEARTBEAT
+    int interval = RuntimeConfig::getInstance().read([](const ConfigSnapshot& config) { return config.heartbeatIntervalS; });
+    auto when = info->lastActivity() + std::chrono::seconds(interval);
+    
+    std::lock_guard<std::mutex> lock(heartbeatMutex);
+    heartbeatTimers.schedule(when, info);
+    if (when < heartbeatDeadline) {
+        heartbeatCv.notify_one();
+    }
+#else
+    (void)info;
+#endif
+}
 
 void Server::heartbeatLoop() {
     LOG_INFO("Heartbeat thread started");
     
+    std::vector<std::weak_ptr<ClientInfo>> due;
+    std::unique_lock<std::mutex> lock(heartbeatMutex);
+    
     while (status == SERVER_STATUS::RUNNING) {
-        std::this_thread::sleep_for(
-            std::chrono::seconds(Constants::HEARTBEAT_INTERVAL_S)
-        );
+        auto now = std::chrono::steady_clock::now();
+        heartbeatDeadline = heartbeatTimers.nextExpiry().value_or(now + std::chrono::seconds(Constants::HEARTBEAT_INTERVAL_S));
+        heartbeatCv.wait_until(lock, heartbeatDeadline);
         
-        #ifdef DISABLE_HEARTBEAT
-        continue;
-        #endif
-        
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            
-            for (auto& [username, info] : clients) {
-                Network::NetworkStream stream(info.socket);
-                (void)stream.send("PING\n");
-                info.waitingForPong = true;
-                LOG_DEBUG("PING sent to " + username);
-            }
+        // Timers of new clients land in the wheel without a wakeup meanwhile
+        heartbeatDeadline = std::chrono::steady_clock::time_point::max();
+        heartbeatTimers.advance(std::chrono::steady_clock::now(), [&due](std::weak_ptr<ClientInfo>&& client) {
+            due.push_back(std::move(client));
+        });
+        if (due.empty()) {
+            continue;
         }
         
-        // Wait a bit for clients to respond
-        std::this_thread::sleep_for(std::chrono::seconds(Constants::HEARTBEAT_CHECK_DELAY_S));
+        // PINGs are sent without the wheel lock, so logins never wait for them
+        lock.unlock();
+        auto rearm = checkIdleClients(due);
+        due.clear();
+        lock.lock();
         
-        checkClientTimeouts();
+        for (auto& [when, client] : rearm) {
+            heartbeatTimers.schedule(when, std::move(client));
+        }
     }
     
     LOG_INFO("Heartbeat thread stopped");
 }
 
-void Server::checkClientTimeouts() {
-    auto now = std::chrono::steady_clock::now();
-    std::vector<std::string> timedOutClients;
+std::vector<Server::HeartbeatTimer> Server::checkIdleClients(std::vector<std::weak_ptr<ClientInfo>>& due) {
+    ConfigSnapshot settings = RuntimeConfig::getInstance().current();
+    auto interval = std::chrono::seconds(settings.heartbeatIntervalS);
+    auto timeout = std::chrono::seconds(settings.heartbeatTimeoutS);
     
+    std::vector<HeartbeatTimer> rearm;
+    std::vector<int> timedOut;
     {
-        std::lock_guard<std::mutex> lock(clientsMutex);
+        std::lock_guard<std::mutex> lock(pingMutex);
+        auto now = std::chrono::steady_clock::now();
         
-        for (const auto& [username, info] : clients) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - info.lastPong
-            ).count();
+        for (auto& client : due) {
+            auto info = client.lock();
+            
+            // Gone, or replaced by a newer login with its own timer
+            if (!info || registry.findBySocket(info->socket) != info) {
+                continue;
+            }
+            
+            // Connections are being handed to a new process: check again later
+            if (handoffActive) {
+                rearm.emplace_back(now + interval, std::move(client));
+                continue;
+            }
             
-            if (elapsed > Constants::HEARTBEAT_TIMEOUT_S) {
-                LOG_WARNING("Client timeout: " + username + 
-                           " (no response for " + std::to_string(elapsed) + "s)");
-                timedOutClients.push_back(username);
+            // Traffic since the timer was armed: just move the timer (lazy reschedule)
+            auto idle = now - info->lastActivity();
+            if (idle < interval) {
+                rearm.emplace_back(info->lastActivity() + interval, std::move(client));
+                continue;
             }
+            
+            if (idle >= timeout) {
+                LOG_WARNING("Client timeout: " + info->session->getUsername() + " (no response for " +
+                           std::to_string(std::chrono::duration_cast<std::chrono::seconds>(idle).count()) + "s)");
+                timedOut.push_back(info->socket);
+                continue;
+            }
+            
+            // Through the session, so the frame never lands inside a delivery
+            if (info->session->send("PING\n")) {
+                info->waitingForPong = true;
+                LOG_DEBUGF("PING sent to {}", info->session->getUsername());
+            }
+            rearm.emplace_back(std::min(now + interval, info->lastActivity() + timeout), std::move(client));
         }
     }
     
-    for (const auto& username : timedOutClients) {
-        int socket = getUserSocket(username);
-        if (socket > 0) {
-            if (commandHandler) {
-                commandHandler->handleDisconnect({}, socket);
-            }
+    for (int socket : timedOut) {
+        if (commandHandler) {
+            commandHandler->handleDisconnect({}, socket);
         }
     }
+    return rearm;
 }
 
 void Server::initializeConfig(int PORT) {
@@ -302,6 +694,7 @@ void Server::initializeCommands() {
     registerCmd("PONG",       &::CommandHandler::handlePong);
     registerCmd("LIST_USERS", &::CommandHandler::handleListUsers);
     registerCmd("GET_LOG",    &::CommandHandler::handleGetLog);
+    registerCmd("HISTORY",    &::CommandHandler::handleHistory);
     
     LOG_INFO("Commands initialized");
 }
@@ -327,25 +720,43 @@ void Server::executeCommand(const std::string& commandName,
 
 void Server::createServerThreads() {
     std::thread acceptThread([this]() {
+        placement.apply(Utils::ThreadRole::ACCEPT);
         acceptClients();
     });
     acceptThread.detach();
     
     std::thread dispatcherThread([this]() {
+        placement.apply(Utils::ThreadRole::DISPATCHER);
         if (dispatcher) {
             dispatcher->run();
         }
     });
     dispatcherThread.detach();
     
+    if (eventLoop) {
+        std::thread eventThread([this]() {
+            placement.apply(Utils::ThreadRole::EVENTS);
+            runEventLoop();
+        });
+        eventThread.detach();
+        LOG_INFO("Event loop thread launched");
+    }
+    
     #ifndef DISABLE_HEARTBEAT
     std::thread heartbeatThread([this]() {
+        placement.apply(Utils::ThreadRole::HEARTBEAT);
         heartbeatLoop();
     });
     heartbeatThread.detach();
     LOG_INFO("Heartbeat thread launched");
     #endif
     
+    std::thread poolMonitorThread([this]() {
+        placement.apply(Utils::ThreadRole::MONITOR);
+        poolMonitorLoop();
+    });
+    poolMonitorThread.detach();
+    
     std::thread adminThread([this]() {
         if (adminHandler) {
             adminHandler->commandLoop();
@@ -359,6 +770,10 @@ void Server::acceptClients() {
     LOG_INFO("Accept thread started");
     
     while (status == SERVER_STATUS::RUNNING) {
+        if (!waitReadable(config.socket, true)) {
+            continue;
+        }
+        
         sockaddr_in clientAddr;
         socklen_t clientLen = sizeof(clientAddr);
         
@@ -371,14 +786,12 @@ void Server::acceptClients() {
             continue;
         }
         
-        LOG_INFO("New connection accepted (socket: " + std::to_string(clientSocket) + ")");
+        LOG_INFOF("New connection accepted (socket: {})", clientSocket);
         
         if (threadPool) {
-            threadPool->enqueue([this, clientSocket]() {
-                handleClientMessages(clientSocket);
-            });
+            startReader(clientSocket);
         } else {
-            LOG_ERROR("ThreadPool not initialized");
+            LOG_ERROR("Worker pool not initialized");
             close(clientSocket);
         }
     }
@@ -386,10 +799,85 @@ void Server::acceptClients() {
     LOG_INFO("Accept thread stopped");
 }
 
+void Server::startReader(int clientSocket) {
+    if (eventLoop) {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        eventConnections.insert(clientSocket);
+        if (!eventLoop->add(clientSocket)) {
+            eventConnections.erase(clientSocket);
+            close(clientSocket);
+        }
+        return;
+    }
+#ifdef ENABLE_COROUTINES
+    if (ioLoop) {
+        runConnection(clientSocket);  // Returns at its first wait
+        return;
+    }
+#endif
+    
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        pendingConnections.insert(clientSocket);
+    }
+    resizeThreadPool();
+    threadPool->enqueue([this, clientSocket]() {
+        handleClientMessages(clientSocket);
+    });
+}
+
+bool Server::waitReadable(int socket, bool listener) {
+    pollfd fds[2] = {{socket, POLLIN, 0}, {handoffEvent, POLLIN, 0}};
+    while (::poll(fds, 2, -1) < 0) {
+        if (errno != EINTR) {
+            return true;  // Let the caller's own call report the error
+        }
+    }
+    
+    // Pending bytes stay in the kernel buffer for whichever process reads next
+    if ((fds[1].revents & POLLIN) && !(fds[0].revents & POLLNVAL)) {
+        parkForHandoff(listener ? PARK_LISTENER : socket);
+        return false;
+    }
+    return true;
+}
+
+void Server::parkForHandoff(int socket) {
+    std::unique_lock<std::mutex> lock(handoffMutex);
+    if (socket == PARK_LISTENER) {
+        listenerParked = true;
+    } else if (socket == PARK_EVENT_LOOP) {
+        eventLoopParked = true;
+    } else {
+        parkedConnections.insert(socket);
+    }
+    handoffCv.notify_all();
+    
+    // On success the process exits while parked here
+    handoffCv.wait(lock, [this] { return !handoffActive; });
+    
+    if (socket == PARK_LISTENER) {
+        listenerParked = false;
+    } else if (socket == PARK_EVENT_LOOP) {
+        eventLoopParked = false;
+    } else {
+        parkedConnections.erase(socket);
+    }
+}
+
 void Server::handleClientMessages(int clientSocket) {
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        pendingConnections.erase(clientSocket);
+        runningReaders++;
+    }
     Network::NetworkStream stream(clientSocket);
     
     while (status == SERVER_STATUS::RUNNING && stream.isConnected()) {
+        if (!waitReadable(clientSocket)) {
+            continue;  // Parked during an aborted upgrade
+        }
+        
         auto maybeMessage = stream.receive();
         
         if (!maybeMessage) {
@@ -401,25 +889,225 @@ void Server::handleClientMessages(int clientSocket) {
             break;
         }
         
+        // Any frame proves the client alive; a PONG needs nothing more
+        touchClient(clientSocket);
         auto parsed = Utils::MessageParser::parse(*maybeMessage);
         
-        if (parsed.isValid) {
+        if (parsed.isValid && parsed.command != "PONG") {
             executeCommand(parsed.command, parsed.arguments, clientSocket);
         }
     }
+    
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        runningReaders--;
+    }
+    handoffCv.notify_all();
+    resizeThreadPool();
+}
+
+#ifdef ENABLE_COROUTINES
+Utils::Detached Server::runConnection(int clientSocket) {
+    Utils::AsyncStream stream(*ioLoop, clientSocket);
+    
+    while (status == SERVER_STATUS::RUNNING) {
+        auto maybeMessage = co_await stream.receive();
+        
+        if (!maybeMessage) {
+            std::string username = getUsernameBySocket(clientSocket);
+            if (!username.empty() && commandHandler) {
+                co_await Utils::resumeOn(*threadPool);
+                commandHandler->handleDisconnect({}, clientSocket);
+            }
+            break;
+        }
+        
+        touchClient(clientSocket);
+        auto parsed = Utils::MessageParser::parse(*maybeMessage);
+        
+        if (parsed.isValid && parsed.command != "PONG") {
+            // Commands may block (durable sends, history reads): off the loop thread
+            co_await Utils::resumeOn(*threadPool);
+            executeCommand(parsed.command, parsed.arguments, clientSocket);
+        }
+    }
+    
+    // Only shut down by closeClientSocket(), so no other wait can see the number reused
+    close(clientSocket);
+}
+#endif
+
+void Server::resizeThreadPool() {
+    // A reader holds its worker for the whole connection, so those workers
+    // come on top of the configured size
+    size_t readers = 0;
+    if (!eventLoop) {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        readers = runningReaders + pendingConnections.size();
+    }
+    threadPool->resize(poolBaseSize + readers);
+}
+
+void Server::poolMonitorLoop() {
+    auto& runtime = RuntimeConfig::getInstance();
+    size_t configured = poolBaseSize;
+    
+    while (status == SERVER_STATUS::RUNNING) {
+        // A configuration change applies at once; autoscaling steps once per interval
+        bool woken;
+        {
+            std::unique_lock<std::mutex> lock(monitorMutex);
+            woken = monitorCv.wait_for(lock, std::chrono::milliseconds(Constants::POOL_MONITOR_INTERVAL_MS),
+                                       [this] { return configChanged; });
+            configChanged = false;
+        }
+        
+        ConfigSnapshot settings = runtime.current();
+        size_t size = static_cast<size_t>(settings.threadPoolSize);
+        size_t base = poolBaseSize;
+        
+        if (!settings.threadPoolAutoscale) {
+            base = size;
+        } else {
+            size_t low = static_cast<size_t>(settings.threadPoolMin);
+            size_t high = std::max(low, static_cast<size_t>(settings.threadPoolMax));
+            double targetWaitMs = settings.threadPoolTargetWaitMs;
+            
+            // A /set of THREAD_POOL_SIZE restarts autoscaling from that size
+            if (size != configured) {
+                base = size;
+            } else if (!woken) {
+                auto sample = threadPool->sample();
+                if (sample.avgWaitMs > targetWaitMs || (sample.queued > 0 && sample.tasks == 0)) {
+                    base += std::max<size_t>(1, base / 4);
+                } else if (sample.avgWaitMs < targetWaitMs / 4 && sample.utilization < 0.5 && base > 0) {
+                    base--;
+                }
+            }
+            base = std::clamp(base, low, high);
+        }
+        configured = size;
+        
+        if (base != poolBaseSize) {
+            LOG_INFO("Thread pool resized: " + std::to_string(poolBaseSize) + " -> " + std::to_string(base) + " worker(s)");
+            poolBaseSize = base;
+        }
+        resizeThreadPool();
+    }
+}
+
+void Server::runEventLoop() {
+    LOG_INFO("Event loop started");
+    std::vector<int> ready;
+    
+    while (status == SERVER_STATUS::RUNNING) {
+        // Sockets reported with the wakeup stay disarmed until served below,
+        // after an aborted upgrade; on success the process exits while parked
+        if (eventLoop->wait(ready)) {
+            parkForHandoff(PARK_EVENT_LOOP);
+        }
+        if (ready.empty()) {
+            continue;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(handoffMutex);
+            runningReaders += ready.size();
+        }
+        for (int socket : ready) {
+            threadPool->enqueue([this, socket]() {
+                serviceConnection(socket);
+            });
+        }
+    }
+    
+    LOG_INFO("Event loop stopped");
+}
+
+void Server::serviceConnection(int clientSocket) {
+    std::vector<std::string> frames;
+    EventLoop::ReadStatus state = eventLoop->read(clientSocket, frames);
+    
+    if (!frames.empty()) {
+        touchClient(clientSocket);
+    }
+    for (const std::string& frame : frames) {
+        auto parsed = Utils::MessageParser::parse(frame);
+        if (parsed.isValid && parsed.command != "PONG") {
+            executeCommand(parsed.command, parsed.arguments, clientSocket);
+        }
+    }
+    
+    if (state == EventLoop::ReadStatus::CLOSED && !getUsernameBySocket(clientSocket).empty() && commandHandler) {
+        commandHandler->handleDisconnect({}, clientSocket);
+    }
+    
+    // Only this task closes the socket: its number cannot be reused by a new
+    // connection while the task still holds it
+    bool closing;
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        closing = closingConnections.erase(clientSocket) != 0 || state == EventLoop::ReadStatus::CLOSED;
+        if (closing || state == EventLoop::ReadStatus::GONE) {
+            eventConnections.erase(clientSocket);
+        }
+    }
+    
+    if (closing) {
+        eventLoop->forget(clientSocket);
+        close(clientSocket);
+    } else if (state == EventLoop::ReadStatus::GONE) {
+        eventLoop->forget(clientSocket);
+    } else {
+        eventLoop->rearm(clientSocket);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        runningReaders--;
+    }
+    handoffCv.notify_all();
+}
+
+void Server::closeClientSocket(int socket) {
+    if (eventLoop) {
+        // The hangup wakes the event loop (or the running task rereads it),
+        // and serviceConnection() closes the socket once no task holds it
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        if (eventConnections.count(socket) != 0 && closingConnections.insert(socket).second) {
+            ::shutdown(socket, SHUT_RDWR);
+        }
+        return;
+    }
+#ifdef ENABLE_COROUTINES
+    if (ioLoop) {
+        ::shutdown(socket, SHUT_RDWR);  // Wakes its coroutine, which closes it
+        return;
+    }
+#endif
+    close(socket);
 }
 
 int Server::getClientCount() const {
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    return static_cast<int>(clients.size());
+    return static_cast<int>(registry.size());
 }
 
 std::unordered_map<std::string, int> Server::getAllClients() {
-    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto entries = registry.snapshot();
     std::unordered_map<std::string, int> result;
-    for (const auto& [username, info] : clients) {
-        result[username] = info.socket;
+    result.reserve(entries.size());
+    for (const auto& info : entries) {
+        result[info->session->getUsername()] = info->socket;
     }
     return result;
 }
 
+std::vector<std::shared_ptr<Session>> Server::getAllSessions() {
+    auto entries = registry.snapshot();
+    std::vector<std::shared_ptr<Session>> result;
+    result.reserve(entries.size());
+    for (const auto& info : entries) {
+        result.push_back(info->session);
+    }
+    return result;
+}
@@ -0,0 +1,21 @@
+#include "Server/Session.hpp"
+#include "Utils/NetworkStream.hpp"
+
+Session::Session(std::string username, int socket, uint64_t generation)
+    : username(std::move(username)), socket(socket), generation(generation) {
+}
+
+bool Session::send(const std::string& message) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (!isActive()) {
+        return false;
+    }
+    
+    Network::NetworkStream stream(socket);
+    return stream.send(message);
+}
+
+void Session::close() {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    active.store(false, std::memory_order_release);
+}
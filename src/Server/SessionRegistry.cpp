@@ -0,0 +1,143 @@
+#include "Server/SessionRegistry.hpp"
+
+SessionRegistry::SessionRegistry() {
+    for (auto& shard : shards) {
+        shard = std::make_unique<Shard>(rcu);
+    }
+}
+
+SessionRegistry::~SessionRegistry() {
+    for (auto& chunk : socketChunks) {
+        delete chunk.load(std::memory_order_relaxed);
+    }
+}
+
+size_t SessionRegistry::shardOf(const std::string& username) {
+    return std::hash<std::string>{}(username) % SHARDS;
+}
+
+std::atomic<ClientInfo*>* SessionRegistry::socketSlot(int socket, bool create) {
+    if (socket < 0 || static_cast<size_t>(socket) >= SOCKET_CHUNK * SOCKET_CHUNKS) {
+        return nullptr;
+    }
+    auto& chunkPtr = socketChunks[static_cast<size_t>(socket) / SOCKET_CHUNK];
+    SocketChunk* chunk = chunkPtr.load(std::memory_order_acquire);
+    if (!chunk && create) {
+        // Chunks are never freed before the registry, so readers need no guard for them
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        chunk = chunkPtr.load(std::memory_order_acquire);
+        if (!chunk) {
+            chunk = new SocketChunk();
+            chunkPtr.store(chunk, std::memory_order_release);
+        }
+    }
+    return chunk ? &(*chunk)[static_cast<size_t>(socket) % SOCKET_CHUNK] : nullptr;
+}
+
+const std::atomic<ClientInfo*>* SessionRegistry::socketSlot(int socket) const {
+    return const_cast<SessionRegistry*>(this)->socketSlot(socket, false);
+}
+
+void SessionRegistry::unindexSocket(const ClientInfo& info) {
+    // The socket may already belong to a newer entry
+    if (auto* slot = socketSlot(info.socket, false)) {
+        ClientInfo* expected = const_cast<ClientInfo*>(&info);
+        slot->compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+    }
+}
+
+SessionRegistry::Entry SessionRegistry::insert(const std::string& username, std::shared_ptr<Session> session) {
+    return store(username, std::move(session), true);
+}
+
+SessionRegistry::Entry SessionRegistry::tryInsert(const std::string& username, std::shared_ptr<Session> session) {
+    return store(username, std::move(session), false);
+}
+
+SessionRegistry::Entry SessionRegistry::store(const std::string& username, std::shared_ptr<Session> session, bool replaceExisting) {
+    Shard& shard = *shards[shardOf(username)];
+    std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+    const Map* current = shard.map.current();
+    if (!replaceExisting && current->contains(username)) {
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<ClientInfo>(std::move(session));
+    auto next = std::make_unique<Map>(*current);
+    Entry& slot = (*next)[username];
+    Entry previous = std::move(slot);
+    slot = entry;
+
+    // Unindex before the grace period of replace(), so no reader can
+    // still reach the previous entry through its socket afterwards
+    if (previous) {
+        unindexSocket(*previous);
+    } else {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Indexed while the shard lock is held: a later remove() of this name
+    // always finds the slot written, and `entry` owns it until replace()
+    if (auto* socket = socketSlot(entry->socket, true)) {
+        socket->store(entry.get(), std::memory_order_release);
+    }
+    shard.map.replace(std::move(next));
+    return entry;
+}
+
+SessionRegistry::Entry SessionRegistry::remove(const std::string& username) {
+    Shard& shard = *shards[shardOf(username)];
+    std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+    const Map* current = shard.map.current();
+    auto it = current->find(username);
+    if (it == current->end()) {
+        return nullptr;
+    }
+
+    Entry removed = it->second;
+    unindexSocket(*removed);
+    auto next = std::make_unique<Map>(*current);
+    next->erase(username);
+    shard.map.replace(std::move(next));
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return removed;
+}
+
+SessionRegistry::Entry SessionRegistry::find(const std::string& username) const {
+    Utils::RcuDomain::ReadGuard guard(rcu);
+    const Map* map = shards[shardOf(username)]->map.get(guard);
+    auto it = map->find(username);
+    return it != map->end() ? it->second : nullptr;
+}
+
+SessionRegistry::Entry SessionRegistry::findBySocket(int socket) const {
+    const auto* slot = socketSlot(socket);
+    if (!slot) {
+        return nullptr;
+    }
+
+    // The entry stays owned by a snapshot until the grace period that follows its unindexing
+    Utils::RcuDomain::ReadGuard guard(rcu);
+    ClientInfo* info = slot->load(std::memory_order_acquire);
+    return info ? info->shared_from_this() : nullptr;
+}
+
+std::vector<SessionRegistry::Entry> SessionRegistry::snapshot() const {
+    std::vector<Entry> result;
+    result.reserve(size());
+
+    Utils::RcuDomain::ReadGuard guard(rcu);
+    for (const auto& shard : shards) {
+        for (const auto& [username, entry] : *shard->map.get(guard)) {
+            result.push_back(entry);
+        }
+    }
+    return result;
+}
+
+void SessionRegistry::clear() {
+    for (const Entry& entry : snapshot()) {
+        remove(entry->session->getUsername());
+    }
+}
@@ -0,0 +1,316 @@
+#include "Utils/BinaryLog.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Utils {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 4096;
+constexpr size_t FORMATS_SIZE = 1 << 20;
+static_assert(sizeof(BinaryLogHeader) <= HEADER_SIZE, "binary log header fits in its page");
+
+int64_t clockNs(clockid_t clock) {
+    timespec now{};
+    ::clock_gettime(clock, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+size_t fileSize(uint64_t capacity) {
+    return HEADER_SIZE + FORMATS_SIZE + capacity * sizeof(BinaryLogRecord);
+}
+
+// Same anchors (within a second) as now: the file was written since the last boot
+bool sameClocks(const BinaryLogHeader& header) {
+    int64_t offset = clockNs(CLOCK_REALTIME) - clockNs(CLOCK_MONOTONIC);
+    int64_t drift = offset - (header.realtimeAnchorNs - header.monotonicAnchorNs);
+    return drift > -1000000000 && drift < 1000000000;
+}
+
+const char* levelLabel(uint8_t level) {
+    // Same order as LogLevel
+    static const char* const LABELS[] = {"DEBUG", "INFO", "WARNING", "ERROR", "CONNECT", "DISCONNECT"};
+    return level < 6 ? LABELS[level] : "UNKNOWN";
+}
+
+// Appends the next argument of a payload the way Logger::format() prints it
+bool appendArgument(const unsigned char* payload, size_t size, size_t& position, std::string& out) {
+    if (position >= size) {
+        return false;
+    }
+    auto tag = static_cast<BinaryArg>(payload[position++]);
+    auto take = [&](void* value, size_t length) {
+        if (position + length > size) {
+            return false;
+        }
+        std::memcpy(value, payload + position, length);
+        position += length;
+        return true;
+    };
+
+    switch (tag) {
+        case BinaryArg::INT: {
+            int64_t value;
+            if (!take(&value, sizeof(value))) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case BinaryArg::UINT: {
+            uint64_t value;
+            if (!take(&value, sizeof(value))) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case BinaryArg::DOUBLE: {
+            double value;
+            if (!take(&value, sizeof(value))) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case BinaryArg::BOOL: {
+            bool value;
+            if (!take(&value, sizeof(value))) return false;
+            out += value ? "true" : "false";
+            return true;
+        }
+        case BinaryArg::CHAR: {
+            char value;
+            if (!take(&value, sizeof(value))) return false;
+            out += value;
+            return true;
+        }
+        case BinaryArg::STRING: {
+            uint16_t length;
+            if (!take(&length, sizeof(length)) || position + length > size) return false;
+            out.append(reinterpret_cast<const char*>(payload + position), length);
+            position += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+BinaryLogWriter::~BinaryLogWriter() {
+    if (base) {
+        ::munmap(base, mappedSize);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool BinaryLogWriter::open(const std::string& path, uint64_t capacity) {
+    if (capacity == 0 || base) {
+        return false;
+    }
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) < 0) {
+        return false;
+    }
+
+    size_t size = fileSize(capacity);
+    bool continued = static_cast<size_t>(info.st_size) == size;
+    if (!continued && (::ftruncate(fd, 0) < 0 || ::ftruncate(fd, static_cast<off_t>(size)) < 0)) {
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    base = static_cast<unsigned char*>(mapping);
+    mappedSize = size;
+    header = reinterpret_cast<BinaryLogHeader*>(base);
+
+    continued = continued && std::memcmp(header->magic, BinaryLogHeader::MAGIC, sizeof(header->magic)) == 0
+                && header->version == BinaryLogHeader::VERSION && header->recordSize == sizeof(BinaryLogRecord)
+                && header->capacity == capacity && header->formatsOffset == HEADER_SIZE
+                && header->formatsSize == FORMATS_SIZE && sameClocks(*header);
+    if (!continued) {
+        // Other geometry, or written before a reboot (monotonic clock reset): start over
+        std::memset(base, 0, size);
+        header->version = BinaryLogHeader::VERSION;
+        header->recordSize = sizeof(BinaryLogRecord);
+        header->capacity = capacity;
+        header->formatsOffset = HEADER_SIZE;
+        header->formatsSize = FORMATS_SIZE;
+        header->realtimeAnchorNs = clockNs(CLOCK_REALTIME);
+        header->monotonicAnchorNs = clockNs(CLOCK_MONOTONIC);
+        header->formatsUsed.store(0, std::memory_order_relaxed);
+        header->nextSequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, BinaryLogHeader::MAGIC, sizeof(header->magic));
+    }
+    ring = reinterpret_cast<BinaryLogRecord*>(base + HEADER_SIZE + FORMATS_SIZE);
+    return true;
+}
+
+uint32_t BinaryLogWriter::registerFormat(std::string_view pattern) {
+    if (!header) {
+        return 0;
+    }
+    uint32_t length = static_cast<uint32_t>(pattern.size());
+    uint64_t offset = header->formatsUsed.fetch_add(sizeof(length) + length, std::memory_order_relaxed);
+    if (offset + sizeof(length) + length > FORMATS_SIZE) {
+        return 0;
+    }
+    // Readable before any record naming it is committed
+    unsigned char* entry = base + HEADER_SIZE + offset;
+    std::memcpy(entry, &length, sizeof(length));
+    std::memcpy(entry + sizeof(length), pattern.data(), length);
+    return static_cast<uint32_t>(offset + 1);
+}
+
+BinaryLogRecord& BinaryLogWriter::claim(uint64_t& sequence) {
+    sequence = header->nextSequence.fetch_add(1, std::memory_order_relaxed);
+    BinaryLogRecord& record = ring[sequence % header->capacity];
+    // Seqlock: readers see 0 while the slot is rewritten, sequence + 1 once published
+    record.commit.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.timeNs = clockNs(CLOCK_MONOTONIC);
+    return record;
+}
+
+BinaryLogReader::~BinaryLogReader() {
+    if (base) {
+        ::munmap(const_cast<unsigned char*>(base), mappedSize);
+    }
+}
+
+bool BinaryLogReader::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        error = path + " is not a binary log";
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    base = static_cast<const unsigned char*>(mapping);
+    mappedSize = size;
+    header = reinterpret_cast<const BinaryLogHeader*>(base);
+
+    if (std::memcmp(header->magic, BinaryLogHeader::MAGIC, sizeof(header->magic)) != 0) {
+        error = path + " is not a binary log";
+        return false;
+    }
+    if (header->version != BinaryLogHeader::VERSION || header->recordSize != sizeof(BinaryLogRecord)) {
+        error = path + ": unsupported binary log version " + std::to_string(header->version);
+        return false;
+    }
+    if (header->formatsOffset + header->formatsSize + header->capacity * sizeof(BinaryLogRecord) > size) {
+        error = path + " is truncated";
+        return false;
+    }
+    ring = reinterpret_cast<const BinaryLogRecord*>(base + header->formatsOffset + header->formatsSize);
+    return true;
+}
+
+uint64_t BinaryLogReader::endSequence() const {
+    return header->nextSequence.load(std::memory_order_acquire);
+}
+
+uint64_t BinaryLogReader::firstSequence() const {
+    uint64_t end = endSequence();
+    return end > header->capacity ? end - header->capacity : 0;
+}
+
+std::string_view BinaryLogReader::pattern(uint32_t formatId) const {
+    uint64_t offset = formatId - 1;
+    uint32_t length;
+    if (formatId == 0 || offset + sizeof(length) > header->formatsSize) {
+        return {};
+    }
+    const unsigned char* entry = base + header->formatsOffset + offset;
+    std::memcpy(&length, entry, sizeof(length));
+    if (offset + sizeof(length) + length > header->formatsSize) {
+        return {};
+    }
+    return std::string_view(reinterpret_cast<const char*>(entry + sizeof(length)), length);
+}
+
+bool BinaryLogReader::line(uint64_t sequence, std::string& out) const {
+    const BinaryLogRecord& slot = ring[sequence % header->capacity];
+    if (slot.commit.load(std::memory_order_acquire) != sequence + 1) {
+        return false;
+    }
+    BinaryLogRecord record;
+    std::memcpy(static_cast<void*>(&record), &slot, sizeof(record));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.commit.load(std::memory_order_relaxed) != sequence + 1) {
+        return false;  // Rewritten while copied
+    }
+
+    int64_t wallNs = header->realtimeAnchorNs + (record.timeNs - header->monotonicAnchorNs);
+    time_t seconds = static_cast<time_t>(wallNs / 1000000000);
+    tm local{};
+    ::localtime_r(&seconds, &local);
+    char timestamp[32];
+    size_t length = std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
+    std::snprintf(timestamp + length, sizeof(timestamp) - length, ".%03d", static_cast<int>((wallNs / 1000000) % 1000));
+
+    out.clear();
+    out.append("[").append(timestamp).append("] [").append(levelLabel(record.level)).append("] ");
+
+    size_t size = std::min<size_t>(record.payloadSize, BinaryLogRecord::PAYLOAD_SIZE);
+    size_t position = 0;
+    if (record.formatId == 0) {
+        appendArgument(record.payload, size, position, out);
+        return true;
+    }
+    // Same substitution as Logger::format()
+    std::string_view text = pattern(record.formatId);
+    size_t cursor = 0;
+    for (uint8_t i = 0; i < record.argCount; ++i) {
+        size_t brace = text.find("{}", cursor);
+        if (brace == std::string_view::npos) {
+            break;
+        }
+        out.append(text, cursor, brace - cursor);
+        if (!appendArgument(record.payload, size, position, out)) {
+            out.append("{}");
+        }
+        cursor = brace + 2;
+    }
+    out.append(text, cursor, std::string_view::npos);
+    return true;
+}
+
+std::vector<std::string> BinaryLogReader::tail(size_t count) const {
+    uint64_t end = endSequence();
+    uint64_t first = firstSequence();
+    if (end - first > count) {
+        first = end - count;
+    }
+    std::vector<std::string> lines;
+    lines.reserve(static_cast<size_t>(end - first));
+    std::string text;
+    for (uint64_t sequence = first; sequence < end; ++sequence) {
+        if (line(sequence, text)) {
+            lines.push_back(text);
+        }
+    }
+    return lines;
+}
+
+} // namespace Utils
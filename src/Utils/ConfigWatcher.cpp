@@ -0,0 +1,106 @@
+#include "Utils/ConfigWatcher.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace Utils {
+
+ConfigWatcher::ConfigWatcher(const std::string& configPath, std::function<void()> onThreadStart)
+    : path(configPath) {
+    std::filesystem::path file(path);
+    std::string directory = file.has_parent_path() ? file.parent_path().string() : ".";
+    fileName = file.filename().string();
+
+    stopFd = ::eventfd(0, EFD_CLOEXEC);
+    inotifyFd = ::inotify_init1(IN_CLOEXEC);
+    if (stopFd < 0 || inotifyFd < 0) {
+        LOG_ERROR("Cannot watch the config file: " + std::string(std::strerror(errno)));
+        return;
+    }
+    // Written in place (IN_CLOSE_WRITE) or replaced by a rename (IN_MOVED_TO)
+    if (::inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LOG_ERROR("Cannot watch " + directory + ": " + std::strerror(errno));
+        return;
+    }
+
+    open = true;
+    thread = std::thread([this, onThreadStart] {
+        if (onThreadStart) {
+            onThreadStart();
+        }
+        run();
+    });
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (stopFd >= 0) {
+        uint64_t one = 1;
+        (void)::write(stopFd, &one, sizeof(one));
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (inotifyFd >= 0) {
+        ::close(inotifyFd);
+    }
+    if (stopFd >= 0) {
+        ::close(stopFd);
+    }
+}
+
+void ConfigWatcher::run() {
+    LOG_INFO("Watching config file " + path);
+    while (waitForChange()) {
+        reload();
+    }
+}
+
+bool ConfigWatcher::waitForChange() {
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    int timeout = -1;  // Until a first event names the file, then until events stop
+
+    while (true) {
+        int ready = ::poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Config file watch failed: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        if (fds[1].revents) {
+            return false;
+        }
+        if (ready == 0) {
+            return true;
+        }
+
+        ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            // An overflowed queue may have lost the event of the file
+            if ((event->len > 0 && fileName == event->name) || (event->mask & IN_Q_OVERFLOW)) {
+                timeout = Constants::CONFIG_RELOAD_DEBOUNCE_MS;
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+}
+
+void ConfigWatcher::reload() {
+    std::string error;
+    if (!RuntimeConfig::getInstance().loadFile(path, error)) {
+        LOG_ERROR("Config file " + path + " rejected (" + error + ") - keeping the current values");
+    }
+}
+
+} // namespace Utils
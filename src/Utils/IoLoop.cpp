@@ -0,0 +1,172 @@
+#ifdef ENABLE_COROUTINES
+
+#include "Utils/IoLoop.hpp"
+#include "Utils/Constants.hpp"
+#include "Utils/Logger.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Utils {
+
+IoLoop::IoLoop(size_t count, std::function<void(size_t)> onThreadStart) {
+    // Level-triggered and never drained: wakes every loop thread for good
+    stopFd = ::eventfd(0, EFD_CLOEXEC);
+    if (stopFd < 0) {
+        LOG_ERROR("Cannot create I/O loop stop event: " + std::string(std::strerror(errno)));
+        return;
+    }
+
+    for (size_t i = 0; i < std::max<size_t>(1, count); ++i) {
+        int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            LOG_ERROR("Cannot create epoll instance: " + std::string(std::strerror(errno)));
+            return;
+        }
+        epollFds.push_back(epollFd);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event) < 0) {
+            LOG_ERROR("Cannot watch I/O loop stop event: " + std::string(std::strerror(errno)));
+            return;
+        }
+    }
+
+    open = true;
+    for (size_t i = 0; i < epollFds.size(); ++i) {
+        threads.emplace_back([this, i, onThreadStart] {
+            if (onThreadStart) {
+                onThreadStart(i);
+            }
+            run(i);
+        });
+    }
+}
+
+IoLoop::~IoLoop() {
+    if (stopFd >= 0) {
+        uint64_t one = 1;
+        (void)::write(stopFd, &one, sizeof(one));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int epollFd : epollFds) {
+        ::close(epollFd);
+    }
+    if (stopFd >= 0) {
+        ::close(stopFd);
+    }
+}
+
+bool IoLoop::watch(int socket, std::coroutine_handle<> coroutine) {
+    if (!open || socket < 0) {
+        return false;
+    }
+    int epollFd = epollFds[static_cast<size_t>(socket) % epollFds.size()];
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = coroutine.address();
+    // Registered on the first wait of a connection, rearmed on the next ones
+    if (::epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event) == 0) {
+        return true;
+    }
+    if (errno == ENOENT && ::epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) == 0) {
+        return true;
+    }
+    LOG_ERROR("Cannot watch socket " + std::to_string(socket) + ": " + std::strerror(errno));
+    return false;
+}
+
+void IoLoop::run(size_t index) {
+    epoll_event events[Constants::EVENT_LOOP_MAX_EVENTS];
+
+    while (true) {
+        int count = ::epoll_wait(epollFds[index], events, Constants::EVENT_LOOP_MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno != EINTR) {
+                LOG_ERROR("epoll_wait failed: " + std::string(std::strerror(errno)));
+                return;
+            }
+            continue;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (!events[i].data.ptr) {
+                return;
+            }
+            std::coroutine_handle<>::from_address(events[i].data.ptr).resume();
+        }
+    }
+}
+
+std::optional<std::string> AsyncStream::takeFrame() {
+    if (pending.size() - offset < sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+    uint32_t networkLength;
+    std::memcpy(&networkLength, pending.data() + offset, sizeof(networkLength));
+    uint32_t length = ntohl(networkLength);
+    if (length == 0 || length > Constants::MAX_MESSAGE_SIZE) {
+        connected = false;  // Same rule as NetworkStream::receive()
+        return std::nullopt;
+    }
+    if (pending.size() - offset - sizeof(networkLength) < length) {
+        return std::nullopt;
+    }
+
+    std::string frame(pending, offset + sizeof(networkLength), length);
+    offset += sizeof(networkLength) + length;
+    if (offset == pending.size()) {
+        std::string().swap(pending);  // Idle connections keep no heap buffer
+        offset = 0;
+    }
+    return frame;
+}
+
+ssize_t AsyncStream::fill() {
+    if (offset > 0) {
+        pending.erase(0, offset);
+        offset = 0;
+    }
+    char chunk[Constants::BUFFER_SIZE];
+    ssize_t received = ::recv(socketFd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (received > 0) {
+        pending.append(chunk, static_cast<size_t>(received));
+    }
+    return received;
+}
+
+Coroutine<std::optional<std::string>> AsyncStream::receive() {
+    while (connected) {
+        if (auto frame = takeFrame()) {
+            co_return frame;
+        }
+        if (!connected) {
+            break;
+        }
+
+        ssize_t received = fill();
+        if (received > 0 || (received < 0 && errno == EINTR)) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && co_await loop.readable(socketFd)) {
+            continue;
+        }
+        connected = false;
+    }
+    std::string().swap(pending);
+    offset = 0;
+    co_return std::nullopt;
+}
+
+} // namespace Utils
+
+#endif // ENABLE_COROUTINES
@@ -1,25 +1,337 @@
 #include "Utils/Logger.hpp"
+#include "Utils/Constants.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
 #include <iostream>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t RING_SLOTS = Constants::ASYNC_LOG_RING_SLOTS;
+
+// A record takes one slot, longer messages continue over the next ones
+struct Slot {
+    int64_t timeNs;   ///< system_clock, first slot only
+    uint32_t length;  ///< Of the whole message, first slot only
+    uint8_t level;
+    uint8_t parts;
+    char text[114];
+};
+static_assert(sizeof(Slot) == 128, "log records are 128 bytes");
+
+constexpr size_t SLOT_TEXT = sizeof(Slot::text);
+constexpr size_t MAX_PARTS = RING_SLOTS / 4;  // Longer messages are cut
+
+struct PendingRecord {
+    int64_t timeNs;
+    LogLevel level;
+    std::string text;
+};
+
+// Formats "YYYY-mm-dd HH:MM:SS.mmm" (23 characters), calling localtime once per second
+struct TimestampCache {
+    time_t second = -1;
+    char prefix[20] = {};
+
+    size_t format(int64_t timeNs, char* out) {
+        time_t now = static_cast<time_t>(timeNs / 1000000000);
+        if (now != second) {
+            tm local{};
+            ::localtime_r(&now, &local);
+            std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &local);
+            second = now;
+        }
+        int ms = static_cast<int>((timeNs / 1000000) % 1000);
+        std::memcpy(out, prefix, 19);
+        out[19] = '.';
+        out[20] = static_cast<char>('0' + ms / 100);
+        out[21] = static_cast<char>('0' + ms / 10 % 10);
+        out[22] = static_cast<char>('0' + ms % 10);
+        return 23;
+    }
+};
+
+// Same layout as TimestampCache from a fixed UTC offset, with arithmetic only
+// (usable in a signal handler); days to civil date as in H. Hinnant's algorithm
+size_t formatLocalTime(int64_t timeNs, int64_t utcOffsetS, char* out) {
+    int64_t seconds = timeNs / 1000000000 + utcOffsetS;
+    int64_t days = seconds / 86400;
+    int64_t daySeconds = seconds % 86400;
+    days += 719468;
+    int64_t era = days / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int64_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int64_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    auto digits = [&out](int64_t value, int width, size_t at) {
+        for (int i = width - 1; i >= 0; --i) {
+            out[at + static_cast<size_t>(i)] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    };
+    std::memcpy(out, "0000-00-00 00:00:00.000", 23);
+    digits(year, 4, 0);
+    digits(month, 2, 5);
+    digits(day, 2, 8);
+    digits(daySeconds / 3600, 2, 11);
+    digits(daySeconds / 60 % 60, 2, 14);
+    digits(daySeconds % 60, 2, 17);
+    digits(timeNs / 1000000 % 1000, 3, 20);
+    return 23;
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void writeAll(int fd, const std::string& data) {
+    writeAll(fd, data.data(), data.size());
+}
+
+} // namespace
+
+/**
+ * @struct LogRing
+ * @brief Single-producer single-consumer record ring of one logging thread
+ */
+struct LogRing {
+    std::array<Slot, RING_SLOTS> slots;
+    alignas(64) std::atomic<uint64_t> head{0};  ///< Written by the owning thread
+    alignas(64) std::atomic<uint64_t> tail{0};  ///< Written by the drain
+    std::atomic<bool> retired{false};            ///< Owner exited: freed once drained
+};
+
+namespace {
+
+struct RingHolder {
+    LogRing* ring = nullptr;
+    bool exited = false;  ///< Logs from later thread_local destructors are synchronous
+    ~RingHolder() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+        exited = true;
+    }
+};
+
+thread_local RingHolder ringHolder;
+
+} // namespace
+
+Logger::~Logger() {
+    setAsync(false);
+    if (logFd >= 0) {
+        ::close(logFd);
+        logFd = -1;
+    }
+}
 
 void Logger::setLogFile(const std::string& filename) {
     std::lock_guard<std::mutex> lock(logMutex);
     
-    if (logFile.is_open()) {
-        logFile.close();
+    if (logFd >= 0) {
+        ::close(logFd);
     }
     
-    logFile.open(filename, std::ios::app);
-    if (!logFile.is_open()) {
+    logFd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd < 0) {
         std::cerr << "Error: Cannot open log file: " << filename << "\n";
+        return;
+    }
+    logPath = filename;
+    
+    // A segment's age counts from its creation, across restarts
+    fileBytes = 0;
+    segmentStart = std::chrono::system_clock::now();
+    struct statx info{};
+    if (::statx(logFd, "", AT_EMPTY_PATH, STATX_SIZE | STATX_BTIME, &info) == 0) {
+        fileBytes = info.stx_size;
+        if ((info.stx_mask & STATX_BTIME) && fileBytes > 0) {
+            segmentStart = std::chrono::system_clock::time_point(std::chrono::seconds(info.stx_btime.tv_sec));
+        }
+    }
+    
+    // Continue the numbering of the segments already rotated
+    std::filesystem::path path(filename);
+    std::string prefix = path.filename().string() + ".";
+    uint64_t last = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(path.has_parent_path() ? path.parent_path() : ".", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0
+            && name.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+            last = std::max<uint64_t>(last, std::strtoull(name.c_str() + prefix.size(), nullptr, 10));
+        }
+    }
+    segment.store(last + 1, std::memory_order_release);
+}
+
+void Logger::setRotation(uint64_t maxBytes, std::chrono::seconds maxAge, size_t keep) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    rotateBytes = maxBytes;
+    rotateAge = maxAge;
+    rotateKeep = keep;
+}
+
+std::string Logger::getSegmentPath(uint64_t number) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (number == segment.load(std::memory_order_relaxed)) {
+        return logPath;
+    }
+    return logPath + "." + std::to_string(number);
+}
+
+void Logger::writeFile(const std::string& data) {
+    if (logFd < 0) {
+        return;
+    }
+    if (fileBytes > 0) {
+        bool full = rotateBytes > 0 && fileBytes + data.size() > rotateBytes;
+        bool old = rotateAge.count() > 0 && std::chrono::system_clock::now() - segmentStart >= rotateAge;
+        if (full || old) {
+            rotate();
+        }
+    }
+    writeAll(logFd, data);
+    fileBytes += data.size();
+}
+
+void Logger::rotate() {
+    // Errors go to stderr: logging from here would take logMutex again
+    uint64_t number = segment.load(std::memory_order_relaxed);
+    std::string closed = logPath + "." + std::to_string(number);
+    if (::rename(logPath.c_str(), closed.c_str()) < 0) {
+        std::cerr << "Error: Cannot rotate log file " << logPath << ": " << std::strerror(errno) << "\n";
+        fileBytes = 0;  // Retried once this segment is full again
+        return;
+    }
+    int fd = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot reopen log file " << logPath << ": " << std::strerror(errno) << "\n";
+    } else {
+        ::close(logFd);
+        logFd = fd;
+    }
+    fileBytes = 0;
+    segmentStart = std::chrono::system_clock::now();
+    segment.store(number + 1, std::memory_order_release);
+    
+    // Oldest first gone; a lowered limit removes the older ones as well
+    for (uint64_t old = number >= rotateKeep ? number - rotateKeep : 0; rotateKeep > 0 && old > 0; --old) {
+        std::string path = logPath + "." + std::to_string(old);
+        if (::unlink(path.c_str()) < 0) {
+            break;
+        }
     }
 }
 
 void Logger::setVerbose(bool enabled) {
     std::lock_guard<std::mutex> lock(logMutex);
     verbose = enabled;
+    if (enabled) {
+        setMinimumLevel(LogLevel::DEBUG);
+    } else if (getMinimumLevel() == LogLevel::DEBUG) {
+        setMinimumLevel(LogLevel::INFO);
+    }
+}
+
+bool Logger::setBinaryLog(const std::string& filename) {
+    auto writer = std::make_unique<Utils::BinaryLogWriter>();
+    if (!writer->open(filename, Constants::BINARY_LOG_RECORDS)) {
+        std::cerr << "Error: Cannot map binary log file: " << filename << " (" << std::strerror(errno) << ")\n";
+        return false;
+    }
+    binaryLog = std::move(writer);
+    binaryLogPath = filename;
+    return true;
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
+    if (!isEnabled(level)) {
+        return;
+    }
+    if (binaryLog) {
+        binaryLog->appendText(static_cast<int>(level), message);
+        if (!showsOnConsole(level)) {
+            return;
+        }
+    }
+    write(level, message);
+}
+
+uint32_t Logger::formatId(FormatSite& site, std::string_view pattern) {
+    uint32_t id = site.id.load(std::memory_order_acquire);
+    if (id == 0) {
+        uint32_t registered = binaryLog->registerFormat(pattern);
+        if (registered == 0) {
+            registered = FormatSite::TEXT;
+        }
+        // Two threads may register the same site: the first ID wins
+        if (site.id.compare_exchange_strong(id, registered, std::memory_order_acq_rel)) {
+            id = registered;
+        }
+    }
+    return id == FormatSite::TEXT ? 0 : id;
+}
+
+void Logger::write(LogLevel level, const std::string& message) {
+    LogRing* owned = async.load(std::memory_order_acquire) ? threadRing() : nullptr;
+    if (owned) {
+        LogRing& ring = *owned;
+        size_t length = std::min(message.size(), MAX_PARTS * SLOT_TEXT);
+        size_t parts = std::max<size_t>(1, (length + SLOT_TEXT - 1) / SLOT_TEXT);
+
+        // Full ring: the writer is behind, wait for it rather than lose the record
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        while (head + parts - ring.tail.load(std::memory_order_acquire) > RING_SLOTS) {
+            writerCv.notify_one();
+            std::this_thread::yield();
+        }
+
+        for (size_t i = 0; i < parts; ++i) {
+            Slot& slot = ring.slots[(head + i) % RING_SLOTS];
+            if (i == 0) {
+                slot.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                slot.length = static_cast<uint32_t>(length);
+                slot.level = static_cast<uint8_t>(level);
+                slot.parts = static_cast<uint8_t>(parts);
+            }
+            size_t offset = i * SLOT_TEXT;
+            std::memcpy(slot.text, message.data() + offset, std::min(SLOT_TEXT, length - offset));
+        }
+        ring.head.store(head + parts, std::memory_order_release);
+
+        if (head + parts - ring.tail.load(std::memory_order_relaxed) > RING_SLOTS / 2) {
+            writerCv.notify_one();
+        }
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(logMutex);
     
     std::string timestamp = getCurrentTimestamp();
@@ -27,9 +339,7 @@ void Logger::log(LogLevel level, const std::string& message) {
     
     std::string logEntry = "[" + timestamp + "] [" + levelStr + "] " + message;
     
-    if (logFile.is_open()) {
-        logFile << logEntry << std::endl;
-    }
+    writeFile(logEntry + "\n");
     
     // Console display: INFO and above, or DEBUG if verbose enabled
     if (level != LogLevel::DEBUG || verbose) {
@@ -38,6 +348,206 @@ void Logger::log(LogLevel level, const std::string& message) {
     }
 }
 
+void Logger::setAsync(bool enabled) {
+    if (enabled == async.load()) {
+        return;
+    }
+
+    if (enabled) {
+        static std::once_flag handlersInstalled;
+        std::call_once(handlersInstalled, [] {
+            struct sigaction action{};
+            action.sa_handler = &Logger::onFatalSignal;
+            action.sa_flags = SA_RESETHAND | SA_NODEFER;
+            sigemptyset(&action.sa_mask);
+            for (int signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+                ::sigaction(signal, &action, nullptr);
+            }
+        });
+
+        // localtime_r is not usable from a signal handler: keep the offset
+        time_t now = ::time(nullptr);
+        tm local{};
+        ::localtime_r(&now, &local);
+        utcOffsetS = local.tm_gmtoff;
+
+        writerRunning = true;
+        writer = std::thread([this] { writerLoop(); });
+        async.store(true, std::memory_order_release);
+        return;
+    }
+
+    async.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerRunning = false;
+    }
+    writerCv.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    drain();
+}
+
+void Logger::flush() {
+    if (async.load(std::memory_order_acquire)) {
+        drain();
+    }
+}
+
+LogRing* Logger::threadRing() {
+    if (!ringHolder.ring && !ringHolder.exited) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        size_t count = ringCount.load(std::memory_order_relaxed);
+        // A drained ring of an exited thread first: drain() holds ringsMutex while reading it
+        for (size_t i = 0; i < count && !ringHolder.ring; ++i) {
+            LogRing* ring = rings[i].load(std::memory_order_relaxed);
+            if (ring->retired.load(std::memory_order_acquire)
+                && ring->tail.load(std::memory_order_acquire) == ring->head.load(std::memory_order_relaxed)) {
+                ring->retired.store(false, std::memory_order_relaxed);
+                ringHolder.ring = ring;
+            }
+        }
+        if (!ringHolder.ring && count < rings.size()) {
+            ringHolder.ring = new LogRing();
+            rings[count].store(ringHolder.ring, std::memory_order_release);
+            ringCount.store(count + 1, std::memory_order_release);
+        }
+    }
+    return ringHolder.ring;
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (writerRunning) {
+        writerCv.wait_for(lock, std::chrono::milliseconds(Constants::ASYNC_LOG_FLUSH_MS));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> drainLock(drainMutex);
+    std::vector<PendingRecord> records;
+
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        size_t count = ringCount.load(std::memory_order_relaxed);
+        for (size_t index = 0; index < count; ++index) {
+            LogRing* ring = rings[index].load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+
+            while (tail < head) {
+                const Slot& first = ring->slots[tail % RING_SLOTS];
+                PendingRecord record{first.timeNs, static_cast<LogLevel>(first.level), {}};
+                record.text.reserve(first.length);
+                for (size_t i = 0; i < first.parts; ++i) {
+                    size_t offset = i * SLOT_TEXT;
+                    record.text.append(ring->slots[(tail + i) % RING_SLOTS].text, std::min<size_t>(SLOT_TEXT, first.length - offset));
+                }
+                tail += first.parts;
+                records.push_back(std::move(record));
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+    }
+    if (records.empty()) {
+        return;
+    }
+
+    // Each ring is in order; interleave the threads by time
+    std::stable_sort(records.begin(), records.end(), [](const PendingRecord& a, const PendingRecord& b) {
+        return a.timeNs < b.timeNs;
+    });
+
+    static TimestampCache timestamps;  // Guarded by drainMutex
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::string fileBatch;
+    std::string consoleBatch;
+    char timestamp[32];
+    for (const PendingRecord& record : records) {
+        std::string_view time(timestamp, timestamps.format(record.timeNs, timestamp));
+        std::string levelStr = levelToString(record.level);
+        fileBatch.append("[").append(time).append("] [").append(levelStr).append("] ").append(record.text).append("\n");
+        if (record.level != LogLevel::DEBUG || verbose) {
+            consoleBatch.append(getColorForLevel(record.level)).append("[").append(time).append("] [").append(levelStr)
+                        .append("]").append(Color::RESET).append(" ").append(record.text).append("\n");
+        }
+    }
+
+    writeFile(fileBatch);
+    std::cout << consoleBatch << std::flush;
+}
+
+void Logger::emergencyDrain() {
+    // Best effort from a crashing thread, which may hold any lock: only
+    // write(2), atomics and arithmetic (no stdio, no localtime, no allocation)
+    static const char* const LEVELS[] = {"DEBUG", "INFO", "WARNING", "ERROR", "CONNECT", "DISCONNECT"};
+
+    size_t count = ringCount.load(std::memory_order_acquire);
+    for (size_t index = 0; index < count; ++index) {
+        LogRing* ring = rings[index].load(std::memory_order_acquire);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        while (tail < head) {
+            const Slot& first = ring->slots[tail % RING_SLOTS];
+            char prefix[64];
+            prefix[0] = '[';
+            size_t length = 1 + formatLocalTime(first.timeNs, utcOffsetS, prefix + 1);
+            const char* level = first.level < 6 ? LEVELS[first.level] : "UNKNOWN";
+            for (const char* part : {"] [", level, "] "}) {
+                size_t size = std::strlen(part);
+                std::memcpy(prefix + length, part, size);
+                length += size;
+            }
+
+            for (int fd : {logFd, static_cast<int>(STDOUT_FILENO)}) {
+                if (fd < 0) {
+                    continue;
+                }
+                writeAll(fd, prefix, length);
+                for (size_t i = 0; i < first.parts; ++i) {
+                    size_t offset = i * SLOT_TEXT;
+                    writeAll(fd, ring->slots[(tail + i) % RING_SLOTS].text, std::min<size_t>(SLOT_TEXT, first.length - offset));
+                }
+                writeAll(fd, "\n", 1);
+            }
+            tail += first.parts;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+}
+
+void Logger::onFatalSignal(int signal) {
+    Logger& logger = getInstance();
+    if (logger.async.load(std::memory_order_acquire)) {
+        logger.emergencyDrain();
+    }
+    // SA_RESETHAND restored the default action: die from the same signal
+    ::raise(signal);
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (LogLevel candidate : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARNING, LogLevel::ERROR}) {
+        if (name == levelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:   return "debug";
+        case LogLevel::INFO:    return "info";
+        case LogLevel::WARNING: return "warning";
+        default:                return "error";
+    }
+}
+
 std::string Logger::getColorForLevel(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:      return Color::GRAY;
@@ -63,15 +573,9 @@ std::string Logger::levelToString(LogLevel level) {
 }
 
 std::string Logger::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()
-    ) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    
-    return ss.str();
-}
\ No newline at end of file
+    static TimestampCache timestamps;  // Guarded by logMutex
+    char timestamp[32];
+    size_t length = timestamps.format(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), timestamp);
+    return std::string(timestamp, length);
+}
@@ -1,27 +1,76 @@
 #include "Utils/RuntimeConfig.hpp"
 #include "Utils/Constants.hpp"
 #include "Utils/Logger.hpp"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+size_t defaultThreadPoolSize() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : Constants::THREAD_POOL_SIZE;
+}
+
+ConfigDef intDef(int ConfigSnapshot::* field, int defaultValue, int minValue, int maxValue) {
+    return { ConfigType::INT, std::to_string(defaultValue), minValue, maxValue, field, nullptr };
+}
+
+ConfigDef boolDef(bool ConfigSnapshot::* field, bool defaultValue) {
+    return { ConfigType::BOOL, defaultValue ? "true" : "false", 0, 0, nullptr, field };
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace
 
 RuntimeConfig::RuntimeConfig() {
     initializeDefinitions();
+    auto defaults = std::make_unique<ConfigSnapshot>();
     for (const auto& [key, def] : definitions) {
-        config[key] = def.defaultValue;
+        assign(*defaults, def, def.defaultValue);
     }
+    snapshot.replace(std::move(defaults));
 }
 
 void RuntimeConfig::initializeDefinitions() {
     using namespace Constants;
     
-    // Format: { type, defaultValue, min, max }
-    definitions["HEARTBEAT_INTERVAL_S"]    = { ConfigType::INT, std::to_string(HEARTBEAT_INTERVAL_S), MIN_HEARTBEAT_INTERVAL_S, 3600 };
-    definitions["HEARTBEAT_CHECK_DELAY_S"] = { ConfigType::INT, std::to_string(HEARTBEAT_CHECK_DELAY_S), 1, 60 };
-    definitions["HEARTBEAT_TIMEOUT_S"]     = { ConfigType::INT, std::to_string(HEARTBEAT_TIMEOUT_S), MIN_HEARTBEAT_TIMEOUT_S, 3600 };
-    definitions["CLIENT_TIMEOUT_S"]        = { ConfigType::INT, std::to_string(CLIENT_TIMEOUT_S), 10, 3600 };
-    definitions["MAX_QUEUE_SIZE"]          = { ConfigType::INT, std::to_string(MAX_QUEUE_SIZE), 10, 100000 };
-    definitions["THREAD_POOL_SIZE"]        = { ConfigType::INT, std::to_string(THREAD_POOL_SIZE), 1, 128 };
-    definitions["MAX_USERNAME_LENGTH"]     = { ConfigType::INT, std::to_string(MAX_USERNAME_LENGTH), MIN_USERNAME_LENGTH, MAX_USERNAME_LENGTH_LIMIT };
-    definitions["MAX_SUBJECT_LENGTH"]      = { ConfigType::INT, std::to_string(MAX_SUBJECT_LENGTH), MIN_SUBJECT_LENGTH, MAX_SUBJECT_LENGTH_LIMIT };
-    definitions["AUTO_STOP_WHEN_NO_CLIENTS"] = { ConfigType::BOOL, AUTO_STOP_WHEN_NO_CLIENTS ? "true" : "false", 0, 0 };
+    using C = ConfigSnapshot;
+    
+    // Format: intDef(field, defaultValue, min, max) / boolDef(field, defaultValue)
+    definitions["HEARTBEAT_INTERVAL_S"]    = intDef(&C::heartbeatIntervalS, HEARTBEAT_INTERVAL_S, MIN_HEARTBEAT_INTERVAL_S, 3600);
+    definitions["HEARTBEAT_CHECK_DELAY_S"] = intDef(&C::heartbeatCheckDelayS, HEARTBEAT_CHECK_DELAY_S, 1, 60);
+    definitions["HEARTBEAT_TIMEOUT_S"]     = intDef(&C::heartbeatTimeoutS, HEARTBEAT_TIMEOUT_S, MIN_HEARTBEAT_TIMEOUT_S, 3600);
+    definitions["CLIENT_TIMEOUT_S"]        = intDef(&C::clientTimeoutS, CLIENT_TIMEOUT_S, 10, 3600);
+    definitions["MAX_QUEUE_SIZE"]          = intDef(&C::maxQueueSize, MAX_QUEUE_SIZE, 10, 100000);
+    definitions["MAX_QUEUE_KB"]            = intDef(&C::maxQueueKb, MAX_QUEUE_KB, 1024, 64 * 1024 * 1024);
+    definitions["MAX_QUEUE_KB_PER_USER"]   = intDef(&C::maxQueueKbPerUser, MAX_QUEUE_KB_PER_USER, 64, 64 * 1024 * 1024);
+    definitions["THREAD_POOL_SIZE"]        = intDef(&C::threadPoolSize, static_cast<int>(defaultThreadPoolSize()), 1, 128);
+    definitions["THREAD_POOL_AUTOSCALE"]   = boolDef(&C::threadPoolAutoscale, false);
+    definitions["THREAD_POOL_MIN"]         = intDef(&C::threadPoolMin, 1, 1, 128);
+    definitions["THREAD_POOL_MAX"]         = intDef(&C::threadPoolMax, THREAD_POOL_MAX, 1, 128);
+    definitions["THREAD_POOL_TARGET_WAIT_MS"] = intDef(&C::threadPoolTargetWaitMs, THREAD_POOL_TARGET_WAIT_MS, 1, 10000);
+    definitions["MAX_USERNAME_LENGTH"]     = intDef(&C::maxUsernameLength, MAX_USERNAME_LENGTH, MIN_USERNAME_LENGTH, MAX_USERNAME_LENGTH_LIMIT);
+    definitions["MAX_SUBJECT_LENGTH"]      = intDef(&C::maxSubjectLength, MAX_SUBJECT_LENGTH, MIN_SUBJECT_LENGTH, MAX_SUBJECT_LENGTH_LIMIT);
+    definitions["OFFLINE_STORE_ENABLED"]   = boolDef(&C::offlineStoreEnabled, true);
+    definitions["OFFLINE_MAX_KB_PER_USER"] = intDef(&C::offlineMaxKbPerUser, OFFLINE_MAX_KB_PER_USER, 16, 1024 * 1024);
+    definitions["OFFLINE_MAX_MB"]          = intDef(&C::offlineMaxMb, OFFLINE_MAX_MB, 1, 1024 * 1024);
+    definitions["OFFLINE_TTL_H"]           = intDef(&C::offlineTtlH, OFFLINE_TTL_H, 0, 366 * 24);
+    definitions["HISTORY_ENABLED"]         = boolDef(&C::historyEnabled, true);
+    definitions["DURABLE_SENDS"]           = boolDef(&C::durableSends, false);
+    definitions["GROUP_COMMIT_DELAY_MS"]   = intDef(&C::groupCommitDelayMs, GROUP_COMMIT_DELAY_MS, 0, 1000);
+    definitions["LOG_ROTATE_SIZE_KB"]      = intDef(&C::logRotateSizeKb, LOG_ROTATE_SIZE_KB, 0, 4 * 1024 * 1024);
+    definitions["LOG_ROTATE_AGE_MIN"]      = intDef(&C::logRotateAgeMin, LOG_ROTATE_AGE_MIN, 0, 366 * 24 * 60);
+    definitions["LOG_ROTATE_KEEP"]         = intDef(&C::logRotateKeep, LOG_ROTATE_KEEP, 1, 1000);
+    definitions["AUTO_STOP_WHEN_NO_CLIENTS"] = boolDef(&C::autoStopWhenNoClients, AUTO_STOP_WHEN_NO_CLIENTS);
 }
 
 bool RuntimeConfig::validateValue(const std::string& key, const std::string& value, const ConfigDef& def) {
@@ -48,55 +97,183 @@ bool RuntimeConfig::validateValue(const std::string& key, const std::string& val
     }
 }
 
+void RuntimeConfig::assign(ConfigSnapshot& config, const ConfigDef& def, const std::string& value) {
+    // Validated beforehand
+    if (def.type == ConfigType::BOOL) {
+        config.*def.boolField = (value == "true" || value == "1");
+    } else {
+        config.*def.intField = std::stoi(value);
+    }
+}
+
 bool RuntimeConfig::set(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> lock(configMutex);
-    
-    auto it = definitions.find(key);
-    if (it == definitions.end()) {
-        LOG_WARNING("Unknown configuration: " + key);
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        
+        auto it = definitions.find(key);
+        if (it == definitions.end()) {
+            LOG_WARNING("Unknown configuration: " + key);
+            return false;
+        }
+        
+        if (!validateValue(key, value, it->second)) {
+            return false;
+        }
+        
+        auto next = std::make_unique<ConfigSnapshot>(*snapshot.current());
+        assign(*next, it->second, value);
+        next->version++;
+        snapshot.replace(std::move(next));
+    }
+    LOG_INFO("Configuration modified: " + key + " = " + value);
+    notifySubscribers();
+    return true;
+}
+
+bool RuntimeConfig::loadFile(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open the file";
         return false;
     }
     
-    if (!validateValue(key, value, it->second)) {
-        return false;
+    // Every line is checked before anything is applied
+    std::vector<std::pair<std::string, std::string>> entries;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); ++number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = "line " + std::to_string(number) + ": expected KEY = value";
+            return false;
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+        auto it = definitions.find(key);
+        if (it == definitions.end()) {
+            error = "line " + std::to_string(number) + ": unknown configuration " + key;
+            return false;
+        }
+        if (!validateValue(key, value, it->second)) {
+            error = "line " + std::to_string(number) + ": invalid value for " + key;
+            return false;
+        }
+        auto duplicate = std::find_if(entries.begin(), entries.end(),
+                                      [&key](const auto& entry) { return entry.first == key; });
+        if (duplicate != entries.end()) {
+            error = "line " + std::to_string(number) + ": " + key + " is set twice";
+            return false;
+        }
+        entries.emplace_back(std::move(key), std::move(value));
     }
     
-    config[key] = value;
-    LOG_INFO("Configuration modified: " + key + " = " + value);
+    std::vector<std::string> changes;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        
+        const ConfigSnapshot& previous = *snapshot.current();
+        auto next = std::make_unique<ConfigSnapshot>(previous);
+        for (const std::string& key : fileKeys) {
+            auto removed = std::find_if(entries.begin(), entries.end(),
+                                        [&key](const auto& entry) { return entry.first == key; });
+            if (removed == entries.end()) {
+                const ConfigDef& def = definitions.find(key)->second;
+                assign(*next, def, def.defaultValue);
+            }
+        }
+        fileKeys.clear();
+        for (const auto& [key, value] : entries) {
+            assign(*next, definitions.find(key)->second, value);
+            fileKeys.push_back(key);
+        }
+        
+        for (const auto& [key, def] : definitions) {
+            std::string value = format(*next, def);
+            if (value != format(previous, def)) {
+                changes.push_back(key + " = " + value);
+            }
+        }
+        if (changes.empty()) {
+            return true;  // Saved again unchanged: nobody to wake
+        }
+        next->version++;
+        snapshot.replace(std::move(next));
+    }
+    for (const std::string& change : changes) {
+        LOG_INFO("Configuration modified: " + change + " (" + path + ")");
+    }
+    notifySubscribers();
     return true;
 }
 
 std::optional<int> RuntimeConfig::getInt(const std::string& key) const {
-    std::lock_guard<std::mutex> lock(configMutex);
-    auto it = config.find(key);
-    if (it == config.end()) {
-        return std::nullopt;
-    }
-    try {
-        return std::stoi(it->second);
-    } catch (...) {
+    auto it = definitions.find(key);
+    if (it == definitions.end() || it->second.type != ConfigType::INT) {
         return std::nullopt;
     }
+    int ConfigSnapshot::* field = it->second.intField;
+    return read([field](const ConfigSnapshot& config) { return config.*field; });
 }
 
 std::optional<bool> RuntimeConfig::getBool(const std::string& key) const {
-    std::lock_guard<std::mutex> lock(configMutex);
-    auto it = config.find(key);
-    if (it == config.end()) {
+    auto it = definitions.find(key);
+    if (it == definitions.end() || it->second.type != ConfigType::BOOL) {
         return std::nullopt;
     }
-    return (it->second == "true" || it->second == "1");
+    bool ConfigSnapshot::* field = it->second.boolField;
+    return read([field](const ConfigSnapshot& config) { return config.*field; });
 }
 
 std::unordered_map<std::string, std::string> RuntimeConfig::listAll() const {
-    std::lock_guard<std::mutex> lock(configMutex);
-    return config;
+    ConfigSnapshot config = current();
+    std::unordered_map<std::string, std::string> values;
+    for (const auto& [key, def] : definitions) {
+        values[key] = format(config, def);
+    }
+    return values;
+}
+
+std::string RuntimeConfig::format(const ConfigSnapshot& config, const ConfigDef& def) {
+    return def.type == ConfigType::BOOL ? (config.*def.boolField ? "true" : "false")
+                                        : std::to_string(config.*def.intField);
 }
 
 void RuntimeConfig::reset() {
-    std::lock_guard<std::mutex> lock(configMutex);
-    for (const auto& [key, def] : definitions) {
-        config[key] = def.defaultValue;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        auto next = std::make_unique<ConfigSnapshot>();
+        for (const auto& [key, def] : definitions) {
+            assign(*next, def, def.defaultValue);
+        }
+        next->version = snapshot.current()->version + 1;
+        snapshot.replace(std::move(next));
     }
     LOG_INFO("Configurations reset to default values");
+    notifySubscribers();
+}
+
+size_t RuntimeConfig::subscribe(Subscriber subscriber) {
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    size_t id = nextSubscription++;
+    subscribers.emplace_back(id, std::move(subscriber));
+    return id;
+}
+
+void RuntimeConfig::unsubscribe(size_t id) {
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                     [id](const auto& entry) { return entry.first == id; }),
+                      subscribers.end());
+}
+
+void RuntimeConfig::notifySubscribers() {
+    // The latest snapshot: concurrent changes may notify out of order, never with stale values
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    ConfigSnapshot config = current();
+    for (const auto& [id, subscriber] : subscribers) {
+        subscriber(config);
+    }
 }
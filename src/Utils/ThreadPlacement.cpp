@@ -0,0 +1,269 @@
+#include "Utils/ThreadPlacement.hpp"
+#include "Utils/Logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Utils {
+
+namespace {
+
+constexpr int MPOL_PREFERRED_MODE = 1;  // <numaif.h> MPOL_PREFERRED, without linking libnuma
+constexpr size_t CONTROL_ROLES_FROM = 4; // auto: CPUs needed to give roles their own
+
+const char* const ROLE_NAMES[THREAD_ROLE_COUNT] = {
+    "accept", "dispatcher", "events", "heartbeat", "monitor", "pool"
+};
+
+// CPU -> NUMA node, from sysfs; empty on machines without NUMA information
+const std::map<int, int>& cpuNodes() {
+    static const std::map<int, int> nodes = [] {
+        std::map<int, int> result;
+        DIR* dir = ::opendir("/sys/devices/system/node");
+        if (!dir) {
+            return result;
+        }
+        while (dirent* entry = ::readdir(dir)) {
+            int node;
+            if (std::sscanf(entry->d_name, "node%d", &node) != 1) {
+                continue;
+            }
+            std::ifstream file(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+            std::string list;
+            std::getline(file, list);
+            for (int cpu : ThreadPlacement::parseCpuList(list)) {
+                result[cpu] = node;
+            }
+        }
+        ::closedir(dir);
+        return result;
+    }();
+    return nodes;
+}
+
+// Prefers the node holding every given CPU; nothing on single-node machines
+void preferLocalNode(const std::vector<int>& cpus) {
+    const auto& nodes = cpuNodes();
+    std::set<int> used;
+    std::set<int> all;
+    for (const auto& [cpu, node] : nodes) {
+        all.insert(node);
+    }
+    for (int cpu : cpus) {
+        auto it = nodes.find(cpu);
+        used.insert(it != nodes.end() ? it->second : -1);
+    }
+    if (all.size() < 2 || used.size() != 1 || *used.begin() < 0 || *used.begin() >= 64) {
+        return;
+    }
+
+    unsigned long mask = 1UL << *used.begin();
+    if (::syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, &mask, sizeof(mask) * 8) != 0) {
+        LOG_WARNING("Cannot prefer NUMA node " + std::to_string(*used.begin()) + ": " + std::strerror(errno));
+    }
+}
+
+std::string formatCpus(const std::vector<int>& cpus) {
+    std::string text;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        text += (text.empty() ? "" : ",") + std::to_string(cpus[i]);
+        if (j > i) {
+            text += "-" + std::to_string(cpus[j]);
+        }
+        i = j;
+    }
+    return text;
+}
+
+} // namespace
+
+const char* ThreadPlacement::roleName(ThreadRole role) {
+    return ROLE_NAMES[static_cast<size_t>(role)];
+}
+
+std::vector<int> ThreadPlacement::parseCpuList(const std::string& list) {
+    std::set<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        int first;
+        int last;
+        char extra;
+        if (std::sscanf(range.c_str(), "%d-%d%c", &first, &last, &extra) == 2) {
+            // Range
+        } else if (std::sscanf(range.c_str(), "%d%c", &first, &extra) == 1) {
+            last = first;
+        } else {
+            return {};
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return {};
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return {cpus.begin(), cpus.end()};
+}
+
+bool ThreadPlacement::parse(const std::string& spec, std::string& error) {
+    if (spec == "auto") {
+        automatic = true;
+        specs.push_back(spec);
+        return true;
+    }
+
+    size_t equals = spec.find('=');
+    std::string name = spec.substr(0, equals);
+    auto role = std::find(std::begin(ROLE_NAMES), std::end(ROLE_NAMES), name);
+    if (equals == std::string::npos || role == std::end(ROLE_NAMES)) {
+        error = "expected auto or <role>=<cpus> with role one of accept, dispatcher, events, heartbeat, monitor, pool";
+        return false;
+    }
+    std::vector<int> cpus = parseCpuList(spec.substr(equals + 1));
+    if (cpus.empty()) {
+        error = "invalid CPU list '" + spec.substr(equals + 1) + "'";
+        return false;
+    }
+    explicitCpus[static_cast<size_t>(role - std::begin(ROLE_NAMES))] = std::move(cpus);
+    specs.push_back(spec);
+    return true;
+}
+
+bool ThreadPlacement::setIrqCpus(const std::string& list, std::string& error) {
+    irqCpus = parseCpuList(list);
+    if (irqCpus.empty()) {
+        error = "invalid CPU list '" + list + "'";
+        return false;
+    }
+    irqList = list;
+    return true;
+}
+
+ThreadPlacement::ThreadPlacement() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return;
+    }
+
+    // Grouped by node, so consecutive picks stay on one node
+    const auto& nodes = cpuNodes();
+    std::vector<std::pair<int, int>> ordered;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            auto it = nodes.find(cpu);
+            ordered.emplace_back(it != nodes.end() ? it->second : 0, cpu);
+        }
+    }
+    std::sort(ordered.begin(), ordered.end());
+    for (const auto& [node, cpu] : ordered) {
+        processCpus.push_back(cpu);
+    }
+}
+
+std::vector<int> ThreadPlacement::availableCpus() const {
+    std::vector<int> cpus;
+    for (int cpu : processCpus) {
+        if (std::find(irqCpus.begin(), irqCpus.end(), cpu) == irqCpus.end()) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus.empty() ? processCpus : cpus;
+}
+
+std::vector<int> ThreadPlacement::automaticCpus(ThreadRole role) const {
+    std::vector<int> cpus = availableCpus();
+    if (cpus.size() < CONTROL_ROLES_FROM) {
+        return role == ThreadRole::POOL ? cpus : std::vector<int>(cpus.begin(), cpus.begin() + std::min<size_t>(1, cpus.size()));
+    }
+    switch (role) {
+        case ThreadRole::DISPATCHER: return {cpus[0]};
+        case ThreadRole::EVENTS:     return {cpus[1]};
+        case ThreadRole::POOL:       return {cpus.begin() + 3, cpus.end()};
+        default:                     return {cpus[2]};
+    }
+}
+
+std::vector<int> ThreadPlacement::cpusFor(ThreadRole role) const {
+    const std::vector<int>& chosen = explicitCpus[static_cast<size_t>(role)];
+    if (!chosen.empty()) {
+        return chosen;
+    }
+    if (automatic) {
+        return automaticCpus(role);
+    }
+    return specs.empty() && irqCpus.empty() ? std::vector<int>() : availableCpus();
+}
+
+void ThreadPlacement::apply(ThreadRole role, size_t index) const {
+    std::string name = std::string("srv-") + roleName(role);
+    if (role == ThreadRole::POOL) {
+        name += "-" + std::to_string(index);
+    }
+    ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str());
+
+    std::vector<int> cpus = cpusFor(role);
+    if (cpus.empty()) {
+        return;
+    }
+    if (role == ThreadRole::POOL) {
+        cpus = {cpus[index % cpus.size()]};
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    int result = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        LOG_WARNING("Cannot pin " + name + " to CPUs " + formatCpus(cpus) + ": " + std::strerror(result));
+        return;
+    }
+    preferLocalNode(cpus);
+}
+
+std::vector<std::string> ThreadPlacement::arguments() const {
+    std::vector<std::string> args;
+    for (const std::string& spec : specs) {
+        args.push_back("--affinity");
+        args.push_back(spec);
+    }
+    if (!irqList.empty()) {
+        args.push_back("--irq-cpus");
+        args.push_back(irqList);
+    }
+    return args;
+}
+
+std::string ThreadPlacement::describe() const {
+    if (specs.empty() && irqCpus.empty()) {
+        return "";
+    }
+    std::string text;
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        std::vector<int> cpus = cpusFor(static_cast<ThreadRole>(i));
+        text += std::string(text.empty() ? "" : " ") + ROLE_NAMES[i] + "=" + (cpus.empty() ? "any" : formatCpus(cpus));
+    }
+    if (!irqCpus.empty()) {
+        text += " (interrupts on " + formatCpus(irqCpus) + ")";
+    }
+    return text;
+}
+
+} // namespace Utils
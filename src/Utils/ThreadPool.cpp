@@ -18,7 +18,7 @@ ThreadPool::~ThreadPool() {
     }
 }
 
-void ThreadPool::enqueue(std::function<void()> task) {
+void ThreadPool::enqueue(Utils::Task task) {
     {
         std::lock_guard<std::mutex> lock(queueMutex);
         tasks.push(std::move(task));
@@ -28,7 +28,7 @@ void ThreadPool::enqueue(std::function<void()> task) {
 
 void ThreadPool::workerThread() {
     while (!stop) {
-        std::function<void()> task;
+        Utils::Task task;
         
         {
             std::unique_lock<std::mutex> lock(queueMutex);
@@ -12,8 +12,8 @@ namespace Utils {
         }
         
         // Utiliser la config runtime pour la longueur max
-        auto maxLength = RuntimeConfig::getInstance().getInt("MAX_USERNAME_LENGTH");
-        size_t limit = maxLength.has_value() ? static_cast<size_t>(maxLength.value()) : Constants::MAX_USERNAME_LENGTH;
+        size_t limit = static_cast<size_t>(RuntimeConfig::getInstance().read(
+            [](const ConfigSnapshot& config) { return config.maxUsernameLength; }));
         
         if (username.length() > limit) {
             return false;
@@ -30,8 +30,8 @@ namespace Utils {
         }
         
         // Utiliser la config runtime pour la longueur max
-        auto maxLength = RuntimeConfig::getInstance().getInt("MAX_SUBJECT_LENGTH");
-        size_t limit = maxLength.has_value() ? static_cast<size_t>(maxLength.value()) : Constants::MAX_SUBJECT_LENGTH;
+        size_t limit = static_cast<size_t>(RuntimeConfig::getInstance().read(
+            [](const ConfigSnapshot& config) { return config.maxSubjectLength; }));
         
         return subject.length() <= limit;
     }
@@ -0,0 +1,357 @@
+#include "Utils/WorkStealingPool.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr int64_t INITIAL_DEQUE_CAPACITY = 256;
+
+// Worker running on this thread, so enqueue() can push to its own deque
+thread_local const void* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+int64_t nanos(std::chrono::steady_clock::time_point when) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+}
+
+} // namespace
+
+// --- Deque ---
+
+WorkStealingPool::Deque::Deque() {
+    rings.push_back(std::make_unique<Ring>(INITIAL_DEQUE_CAPACITY));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+}
+
+WorkStealingPool::Deque::~Deque() {
+    while (Job* task = pop()) {
+        delete task;
+    }
+}
+
+WorkStealingPool::Deque::Ring* WorkStealingPool::Deque::grow(Ring* current, int64_t b, int64_t t) {
+    auto bigger = std::make_unique<Ring>(current->capacity * 2);
+    for (int64_t i = t; i < b; ++i) {
+        bigger->put(i, current->get(i));
+    }
+    rings.push_back(std::move(bigger));
+    return rings.back().get();
+}
+
+void WorkStealingPool::Deque::push(Job* task) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Ring* current = ring.load(std::memory_order_relaxed);
+    if (b - t > current->capacity - 1) {
+        current = grow(current, b, t);
+        ring.store(current, std::memory_order_release);
+    }
+    current->put(b, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+WorkStealingPool::Job* WorkStealingPool::Deque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring* current = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);  // Empty
+        return nullptr;
+    }
+
+    Job* task = current->get(b);
+    if (t == b) {
+        // Last task: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+WorkStealingPool::Job* WorkStealingPool::Deque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job* task = ring.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;  // Lost to the owner or another thief
+    }
+    return task;
+}
+
+bool WorkStealingPool::Deque::empty() const {
+    return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+}
+
+size_t WorkStealingPool::Deque::size() const {
+    int64_t t = top.load(std::memory_order_acquire);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+}
+
+// --- Pool ---
+
+WorkStealingPool::WorkStealingPool(size_t numThreads, std::function<void(size_t)> onWorkerStart)
+    : onWorkerStart(std::move(onWorkerStart)), lastSample(Clock::now()) {
+    resize(numThreads);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stop = true;
+    }
+    condition.notify_all();
+
+    for (size_t i = 0; i < highWater.load(); ++i) {
+        if (workers[i]->thread.joinable()) {
+            workers[i]->thread.join();
+        }
+    }
+    for (Job* task : injected) {
+        delete task;
+    }
+}
+
+void WorkStealingPool::resize(size_t numThreads) {
+    numThreads = std::clamp<size_t>(numThreads, 1, MAX_THREADS);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stop) {
+            return;
+        }
+        target.store(numThreads, std::memory_order_relaxed);
+
+        // A slot still running (retiring or not) just sees it is wanted again
+        for (size_t i = 0; i < numThreads; ++i) {
+            if (i >= highWater.load(std::memory_order_relaxed)) {
+                workers[i] = std::make_unique<Worker>();
+                highWater.store(i + 1, std::memory_order_release);
+                startWorker(i);
+            } else if (workers[i]->exited) {
+                workers[i]->thread.join();  // Already past its last lock
+                startWorker(i);
+            }
+        }
+    }
+    // Sleepers above the new size wake up to exit
+    condition.notify_all();
+}
+
+void WorkStealingPool::startWorker(size_t index) {
+    Worker& worker = *workers[index];
+    worker.exited = false;
+    worker.started = Clock::now();
+    worker.busyAtStart = worker.busyNs.load(std::memory_order_relaxed);
+    worker.tasksAtStart = worker.tasks.load(std::memory_order_relaxed);
+    worker.thread = std::thread([this, index] { workerThread(index); });
+}
+
+void WorkStealingPool::enqueue(Utils::Task task) {
+    Job* item = new Job{std::move(task), Clock::now()};
+
+    if (currentPool == this) {
+        workers[currentWorker]->deque.push(item);
+    } else {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        injected.push_back(item);
+        injectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeOne();
+}
+
+void WorkStealingPool::wakeOne() {
+    // Pairs with the fence in workerThread(): either the sleeper sees the new
+    // task in its last scan, or we see it counted as sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        condition.notify_one();
+    }
+}
+
+WorkStealingPool::Job* WorkStealingPool::takeInjected() {
+    if (injectedCount.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (injected.empty()) {
+        return nullptr;
+    }
+    Job* task = injected.front();
+    injected.pop_front();
+    injectedCount.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+WorkStealingPool::Job* WorkStealingPool::findTask(size_t index, bool retiring) {
+    if (Job* task = workers[index]->deque.pop()) {
+        return task;
+    }
+    if (retiring) {
+        return nullptr;  // Leaves shared work to the workers that stay
+    }
+    if (Job* task = takeInjected()) {
+        return task;
+    }
+
+    // Start at the next worker so thieves spread over the victims
+    size_t count = highWater.load(std::memory_order_acquire);
+    for (size_t i = 1; i < count; ++i) {
+        if (Job* task = workers[(index + i) % count]->deque.steal()) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingPool::runTask(Worker& worker, Job* task) {
+    Clock::time_point start = Clock::now();
+    uint64_t wait = static_cast<uint64_t>(std::max<int64_t>(0, nanos(start) - nanos(task->enqueued)));
+    worker.waitNs.store(worker.waitNs.load(std::memory_order_relaxed) + wait, std::memory_order_relaxed);
+    if (wait > worker.maxWaitNs.load(std::memory_order_relaxed)) {
+        worker.maxWaitNs.store(wait, std::memory_order_relaxed);
+    }
+    worker.tasks.store(worker.tasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    worker.runningSince.store(nanos(start), std::memory_order_relaxed);
+
+    task->run();
+    delete task;
+
+    uint64_t busy = static_cast<uint64_t>(nanos(Clock::now()) - nanos(start));
+    worker.busyNs.store(worker.busyNs.load(std::memory_order_relaxed) + busy, std::memory_order_relaxed);
+    worker.runningSince.store(0, std::memory_order_relaxed);
+}
+
+void WorkStealingPool::workerThread(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    Worker& self = *workers[index];
+    if (onWorkerStart) {
+        onWorkerStart(index);
+    }
+
+    while (true) {
+        bool retiring = index >= target.load(std::memory_order_relaxed);
+        if (Job* task = findTask(index, retiring)) {
+            runTask(self, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (index >= target.load(std::memory_order_relaxed) && self.deque.empty()) {
+            self.exited = true;
+            condition.notify_one();  // In case the wakeup meant for a stayer reached us
+            return;
+        }
+        if (retiring) {
+            continue;  // Wanted again since the check above
+        }
+
+        sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Scan again now that enqueue() can see us asleep
+        bool pending = !injected.empty();
+        size_t count = highWater.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count && !pending; ++i) {
+            pending = !workers[i]->deque.empty();
+        }
+        if (!pending) {
+            if (stop) {
+                sleeping.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            condition.wait(lock);
+        }
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+size_t WorkStealingPool::queued() const {
+    size_t total = injectedCount.load(std::memory_order_relaxed);
+    size_t count = highWater.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        total += workers[i]->deque.size();
+    }
+    return total;
+}
+
+WorkStealingPool::Stats WorkStealingPool::getStats() const {
+    Stats stats{};
+    stats.size = target.load(std::memory_order_relaxed);
+    stats.queued = queued();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    int64_t now = nanos(Clock::now());
+    uint64_t waitNs = 0;
+    uint64_t maxWaitNs = 0;
+    for (size_t i = 0; i < highWater.load(std::memory_order_relaxed); ++i) {
+        const Worker& worker = *workers[i];
+        uint64_t tasks = worker.tasks.load(std::memory_order_relaxed);
+        stats.completed += tasks;
+        waitNs += worker.waitNs.load(std::memory_order_relaxed);
+        maxWaitNs = std::max(maxWaitNs, worker.maxWaitNs.load(std::memory_order_relaxed));
+        if (worker.exited) {
+            continue;
+        }
+
+        int64_t running = worker.runningSince.load(std::memory_order_relaxed);
+        double busy = static_cast<double>(worker.busyNs.load(std::memory_order_relaxed) - worker.busyAtStart) +
+                      static_cast<double>(running > 0 ? now - running : 0);
+        double alive = static_cast<double>(std::max<int64_t>(1, now - nanos(worker.started)));
+        stats.workers.push_back({i, tasks - worker.tasksAtStart, std::min(1.0, busy / alive), i >= stats.size});
+    }
+    if (stats.completed > 0) {
+        stats.avgWaitMs = static_cast<double>(waitNs) / static_cast<double>(stats.completed) / 1e6;
+    }
+    stats.maxWaitMs = static_cast<double>(maxWaitNs) / 1e6;
+    return stats;
+}
+
+WorkStealingPool::Sample WorkStealingPool::sample() {
+    Sample result{};
+    result.queued = queued();
+
+    uint64_t tasks = 0;
+    uint64_t waitNs = 0;
+    uint64_t busyNs = 0;
+    size_t live = 0;
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (size_t i = 0; i < highWater.load(std::memory_order_relaxed); ++i) {
+            const Worker& worker = *workers[i];
+            int64_t running = worker.runningSince.load(std::memory_order_relaxed);
+            tasks += worker.tasks.load(std::memory_order_relaxed);
+            waitNs += worker.waitNs.load(std::memory_order_relaxed);
+            busyNs += worker.busyNs.load(std::memory_order_relaxed) +
+                      static_cast<uint64_t>(running > 0 ? std::max<int64_t>(0, nanos(now) - running) : 0);
+            live += worker.exited ? 0 : 1;
+        }
+    }
+
+    result.tasks = tasks - lastTasks;
+    if (result.tasks > 0) {
+        result.avgWaitMs = static_cast<double>(waitNs - lastWaitNs) / static_cast<double>(result.tasks) / 1e6;
+    }
+    double interval = static_cast<double>(std::max<int64_t>(1, nanos(now) - nanos(lastSample)));
+    // Running tasks were counted up to now last time, so the busy total never goes back
+    double busy = busyNs > lastBusyNs ? static_cast<double>(busyNs - lastBusyNs) : 0.0;
+    result.utilization = live > 0 ? std::min(1.0, busy / (interval * static_cast<double>(live))) : 0.0;
+
+    lastSample = now;
+    lastTasks = tasks;
+    lastWaitNs = waitNs;
+    lastBusyNs = busyNs;
+    return result;
+}
@@ -0,0 +1,67 @@
+#include "Utils/BinaryLog.hpp"
+#include "Utils/Constants.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    std::string path = Constants::DEFAULT_BINARY_LOG;
+    size_t count = 0;  // 0: every record of the ring
+    bool follow = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-n" || arg == "--lines") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: -n/--lines requires an argument\n";
+                return 1;
+            }
+            count = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-f" || arg == "--follow") {
+            follow = true;
+        } else if (arg == "-h" || arg == "--help") {
+            std::cout << "Usage: " << argv[0] << " [OPTIONS] [file]\n";
+            std::cout << "Prints a binary log (default: " << Constants::DEFAULT_BINARY_LOG << ") in the text log layout\n";
+            std::cout << "Options:\n";
+            std::cout << "  -n, --lines <num>   Print only the last <num> records\n";
+            std::cout << "  -f, --follow        Keep printing records as they are written\n";
+            std::cout << "  -h, --help          Show this help message\n";
+            return 0;
+        } else {
+            path = arg;
+        }
+    }
+
+    Utils::BinaryLogReader reader;
+    std::string error;
+    if (!reader.open(path, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    uint64_t next = reader.firstSequence();
+    uint64_t end = reader.endSequence();
+    if (count > 0 && end - next > count) {
+        next = end - count;
+    }
+
+    std::string line;
+    while (true) {
+        for (end = reader.endSequence(); next < end; ++next) {
+            // Skipped: overwritten by the writer since, or still being written
+            if (next < reader.firstSequence() || !reader.line(next, line)) {
+                continue;
+            }
+            std::cout << line << '\n';
+        }
+        if (!follow) {
+            break;
+        }
+        std::cout.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(Constants::ASYNC_LOG_FLUSH_MS * 10));
+    }
+    return 0;
+}
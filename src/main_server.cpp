@@ -1,6 +1,8 @@
 #include "Server/Server.hpp"
 #include "Utils/Logger.hpp"
 #include "Utils/Constants.hpp"
+#include "Utils/RuntimeConfig.hpp"
+#include <filesystem>
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
@@ -22,12 +24,32 @@ int main(int argc, char* argv[]) {
     int port = Constants::DEFAULT_PORT;
     int maxConnections = 100;
     bool verbose = false;
+    bool eventLoop = false;
+    bool asyncLog = false;
+    bool binaryLog = false;
+    std::string logLevel;
+    Utils::ThreadPlacement placement;
+    std::string takeoverPath;
+    std::string configPath;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         
         if (arg == "-v" || arg == "--verbose") {
             verbose = true;
+        } else if (arg == "-e" || arg == "--event-loop") {
+            eventLoop = true;
+        } else if (arg == "--async-log") {
+            asyncLog = true;
+        } else if (arg == "--binary-log") {
+            binaryLog = true;
+        } else if (arg == "--log-level") {
+            LogLevel parsed;
+            if (i + 1 >= argc || !Logger::parseLevel(argv[i + 1], parsed)) {
+                std::cerr << "Error: --log-level requires debug, info, warning or error\n";
+                return 1;
+            }
+            logLevel = argv[++i];
         } else if (arg == "-p" || arg == "--port") {
             if (i + 1 < argc) {
                 port = std::atoi(argv[++i]);
@@ -49,27 +71,88 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: -c/--connections requires an argument\n";
                 return 1;
             }
+        } else if (arg == "-a" || arg == "--affinity" || arg == "--irq-cpus") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            std::string error;
+            bool valid = (arg == "--irq-cpus") ? placement.setIrqCpus(argv[++i], error)
+                                               : placement.parse(argv[++i], error);
+            if (!valid) {
+                std::cerr << "Error: " << arg << ": " << error << "\n";
+                return 1;
+            }
+        } else if (arg == "--config") {
+            if (i + 1 < argc) {
+                configPath = argv[++i];
+            } else {
+                std::cerr << "Error: --config requires an argument\n";
+                return 1;
+            }
+        } else if (arg == "--takeover") {
+            if (i + 1 < argc) {
+                takeoverPath = argv[++i];
+            } else {
+                std::cerr << "Error: --takeover requires an argument\n";
+                return 1;
+            }
         } else if (arg == "-h" || arg == "--help") {
             std::cout << "Usage: " << argv[0] << " [OPTIONS]\n";
             std::cout << "Options:\n";
             std::cout << "  -p, --port <port>           Server port (default: " << Constants::DEFAULT_PORT << ")\n";
             std::cout << "  -c, --connections <num>     Max connections (default: 100)\n";
             std::cout << "  -v, --verbose               Enable verbose logging (show DEBUG messages)\n";
+            std::cout << "  -e, --event-loop            Serve connections from an epoll loop (no thread per idle client)\n";
+            std::cout << "  --async-log                 Log through per-thread rings and a background writer\n";
+            std::cout << "  --binary-log                Log to the binary ring " << Constants::DEFAULT_BINARY_LOG
+                      << " (read with logdump)\n";
+            std::cout << "  --log-level <level>         Minimum log level: debug, info (default), warning, error\n";
+            std::cout << "  -a, --affinity <spec>       Pin threads: auto, or <role>=<cpus> (roles: accept, dispatcher,\n"
+                      << "                              events, heartbeat, monitor, pool), repeatable\n";
+            std::cout << "  --irq-cpus <cpus>           CPUs handling NIC interrupts, kept free of server threads\n";
+            std::cout << "  --config <file>             Load KEY = value settings, reloaded when the file changes\n";
+            std::cout << "  --takeover <socket>         Take over a running server (started by /upgrade)\n";
             std::cout << "  -h, --help                  Show this help message\n";
             return 0;
         }
     }
     
-    Logger::getInstance().setLogFile(Constants::DEFAULT_SERVER_LOG);
+    if (binaryLog) {
+        if (!Logger::getInstance().setBinaryLog(Constants::DEFAULT_BINARY_LOG)) {
+            return 1;
+        }
+    } else {
+        Logger::getInstance().setLogFile(Constants::DEFAULT_SERVER_LOG);
+    }
     Logger::getInstance().setVerbose(verbose);
+    LogLevel minimumLevel;
+    if (Logger::parseLevel(logLevel, minimumLevel)) {
+        Logger::getInstance().setMinimumLevel(minimumLevel);
+    }
+    Logger::getInstance().setAsync(asyncLog);
+    
+    if (!configPath.empty()) {
+        configPath = std::filesystem::absolute(configPath).string();  // Also given to /upgrade successors
+        std::string error;
+        if (!RuntimeConfig::getInstance().loadFile(configPath, error)) {
+            std::cerr << "Error: " << configPath << ": " << error << "\n";
+            return 1;
+        }
+    }
     
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
     
     Server server;
     globalServer = &server;
+    server.setEventLoop(eventLoop);
+    server.setPlacement(placement);
+    server.setConfigFile(configPath);
     
-    if (server.start(port, maxConnections) != 0) {
+    int result = takeoverPath.empty() ? server.start(port, maxConnections)
+                                      : server.takeover(takeoverPath, maxConnections);
+    if (result != 0) {
         LOG_ERROR("Failed to start server");
         return 1;
     }